@@ -3,13 +3,62 @@
 
 #include <random>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <future>
+#include <memory>
+#include <cmath>
+#include <numbers>
+#include <limits>
+#include <charconv>
+#include <chrono>
+#include <ranges>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// datasets are memory-mapped where POSIX mmap is available and read into memory elsewhere
+#if defined(__unix__) || defined(__APPLE__)
+#define MMAP_FILES
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// MSVC compiles intrinsics without target flags, GCC and Clang need them per function
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define TARGET_AVX2
+#define TARGET_SSE41
+#endif
 
 #include "imgui.h"
 #include "imgui-SFML.h"
 
-const unsigned int screenWidth = sf::VideoMode::getDesktopMode().width;
-const unsigned int screenHeight = sf::VideoMode::getDesktopMode().height;
-
 sf::RenderWindow window;
 sf::Clock deltaClock;
 
@@ -22,24 +71,130 @@ const float minPitch = 0.5;
 
 double sleepRatio = 1.0;
 
+// base colors of the bars (white where unset), used by algorithms to mark runs, blocks or buckets
+std::vector<sf::Color> elementColors;
+
+// indices drawn red in addition to the update indices, e.g. all exchanged pairs of a sorting network layer
+std::vector<int> highlightedIndices;
+
+// palette for marking consecutive segments such as runs or buckets
+const sf::Color segmentColors[] = {
+        sf::Color(100, 180, 255),
+        sf::Color(120, 230, 120),
+        sf::Color(255, 200, 80),
+        sf::Color(200, 130, 255),
+        sf::Color(80, 220, 220),
+};
+
+// set by --headless: sorts run at native speed without a window and visualize() does nothing
+bool headless = false;
+
+// operation counters of the running sort, shown next to the stop button.
+// Per thread, parallelFor() adds the counts of its workers to the calling thread.
+thread_local unsigned long long comparisonCount = 0;
+thread_local unsigned long long writeCount = 0;
+
+// relative cost of one read, write and comparison for the modeled time, e.g. writes 10-100x reads on flash
+float readCost = 1.0f;
+float writeCost = 1.0f;
+float compareCost = 1.0f;
+
+// reads are not counted separately: every comparison reads two elements and every write reads its source
+double modeledCost() {
+    double reads = 2.0 * comparisonCount + writeCount;
+    return reads * readCost + writeCount * writeCost + comparisonCount * compareCost;
+}
+
+// busy loop iterations spent in every lessThan() to model an expensive comparator, set by --compare-work
+int comparisonWork = 0;
+volatile int comparisonSink = 0;
+
+// seed of all random input, shown in the controls window and by headless runs so a run can be repeated with --seed
+std::uint64_t randomSeed = (std::uint64_t) std::random_device()() << 32 | std::random_device()();
+
+// worker threads used by parallel algorithms in headless mode, set by --threads
+int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+// extra lines an algorithm wants printed below its result in headless mode, e.g. a time breakdown per phase
+std::vector<std::string> sortReport;
+
+// McIlroy's antiqsort adversary: every element starts as gas, larger than every solid value, and when two gas elements
+// meet the one that is not the pivot candidate freezes to the next solid value. Elements sorted through it steer a
+// quick sort to its worst pivots and the frozen values are an input that repeats that run. Works on element ids
+// 0 ... size - 1.
+struct AntiQuicksort {
+    std::vector<int> values;
+    int gas;
+    int solidCount = 0;
+    int candidate = 0;
+
+    explicit AntiQuicksort(int size) : values(size, size), gas(size) {
+    }
+
+    bool less(int a, int b) {
+        if (values[a] == gas && values[b] == gas) {
+            values[a == candidate ? a : b] = solidCount++;
+        }
+        if (values[a] == gas) {
+            candidate = a;
+        } else if (values[b] == gas) {
+            candidate = b;
+        }
+        return values[a] < values[b];
+    }
+
+    // freezes the remaining gas in order, the values are then a permutation of 0 ... size - 1
+    void freezeAll() {
+        for (int &value: values) {
+            if (value == gas) {
+                value = solidCount++;
+            }
+        }
+    }
+};
+
+// adversary answering lessThan() while set, the array then holds the element ids 1 ... n instead of values
+AntiQuicksort *activeAdversary = nullptr;
+
 void drawArray(sf::RenderTexture &target, std::vector<int> &array, int updateIndexA = -1, int updateIndexB = -1) {
 
     unsigned int rectWidth = std::max((int) (target.getSize().x / array.size()), 1);
     unsigned int maxRectHeight = target.getSize().y;
-    int maxElement = *std::max_element(array.begin(), array.end());
+    int maxElement = activeAdversary != nullptr ? activeAdversary->gas : *std::max_element(array.begin(), array.end());
+
+    std::vector<bool> highlighted(array.size());
+    for (int index: highlightedIndices) {
+        highlighted[index] = true;
+    }
 
     target.clear();
 
     // draw rectangles
     for (int i = 0; i < array.size(); i++) {
 
-        sf::RectangleShape rect(sf::Vector2f(rectWidth, (array[i] * maxRectHeight) / maxElement));
+        // against the adversary the bars show the values frozen so far and gas elements are gray at full height,
+        // anything that is not an id, like the zeros of a merge buffer, is drawn as it is
+        int element = array[i];
+        bool gas = false;
+        if (activeAdversary != nullptr && element >= 1 && element <= activeAdversary->values.size()) {
+            element = activeAdversary->values[element - 1] + 1;
+            gas = element > maxElement;
+            element = std::min(element, maxElement);
+        }
+
+        sf::RectangleShape rect(sf::Vector2f(rectWidth, (element * maxRectHeight) / maxElement));
 
         // position rectangles at the bottom
         rect.setPosition(i * rectWidth, maxRectHeight - rect.getSize().y);
 
         // set color red if updated
-        rect.setFillColor(i == updateIndexA || i == updateIndexB ? sf::Color::Red : sf::Color::White);
+        if (i == updateIndexA || i == updateIndexB || highlighted[i]) {
+            rect.setFillColor(sf::Color::Red);
+        } else if (gas) {
+            rect.setFillColor(sf::Color(110, 110, 110));
+        } else {
+            rect.setFillColor(i < elementColors.size() ? elementColors[i] : sf::Color::White);
+        }
 
         target.draw(rect);
     }
@@ -79,6 +234,10 @@ void stopButtonWindow() {
     ImGui::SetWindowPos(ImVec2(0, 0));
     ImGui::SetWindowSize(ImVec2(window.getSize().x / 8, window.getSize().y / 8));
 
+    ImGui::Text("comparisons: %llu", comparisonCount);
+    ImGui::Text("writes: %llu", writeCount);
+    ImGui::Text("modeled cost: %.0f", modeledCost());
+
     if (ImGui::Button("stop")) {
         ImGui::End();
 
@@ -93,6 +252,10 @@ void stopButtonWindow() {
 
 void visualize(std::vector<int> &array, sf::Time delay, int updateIndexA = -1, int updateIndexB = -1) {
 
+    if (headless) {
+        return;
+    }
+
     delay = sf::microseconds(delay.asMicroseconds() / sleepRatio);
 
     sf::RenderTexture windowTexture;
@@ -129,6 +292,37 @@ void visualize(std::vector<int> &array, sf::Time delay, int updateIndexA = -1, i
     } while (clock.getElapsedTime() < delay);
 }
 
+// visualizes a batch of operations that happen at once, highlighting all of their indices
+void visualizeBatch(std::vector<int> &array, sf::Time delay, const std::vector<int> &indices) {
+    highlightedIndices = indices;
+    visualize(array, delay);
+    highlightedIndices.clear();
+}
+
+// only int arrays are drawn, the generic algorithms sort other element types headless
+template<typename T>
+void visualize(std::vector<T> &, sf::Time, int = -1, int = -1) {
+}
+
+template<typename T>
+void visualizeBatch(std::vector<T> &, sf::Time, const std::vector<int> &) {
+}
+
+// visualize() and visualizeBatch() for the generic algorithms, compiled out unless their policy draws
+template<typename Less, typename T>
+void visualizeWith(const Less &, std::vector<T> &array, sf::Time delay, int updateIndexA = -1, int updateIndexB = -1) {
+    if constexpr (Less::Policy::draws) {
+        visualize(array, delay, updateIndexA, updateIndexB);
+    }
+}
+
+template<typename Less, typename T>
+void visualizeBatchWith(const Less &, std::vector<T> &array, sf::Time delay, const std::vector<int> &indices) {
+    if constexpr (Less::Policy::draws) {
+        visualizeBatch(array, delay, indices);
+    }
+}
+
 void visualizeWait(std::vector<int> &array, sf::Time delay) {
     double tmpRatio = sleepRatio;
     sleepRatio = 1.0;
@@ -139,319 +333,5321 @@ void visualizeWait(std::vector<int> &array, sf::Time delay) {
 void writeVisualize(std::vector<int> &src, std::vector<int> &dst, sf::Time delay) {
     for (int i = 0; i < src.size(); i++) {
         dst[i] = src[i];
+        writeCount++;
         visualize(dst, delay, i);
     }
 }
 
-void shuffle(std::vector<int> &array, sf::Time delay = sf::milliseconds(1)) {
+void colorRange(int begin, int end, sf::Color color) {
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    if (headless) {
+        return;
+    }
 
-    for (int i = 0; i < array.size(); i++) {
-        std::uniform_int_distribution<> dis(0, array.size() - 1);
-        int rand = dis(gen);
+    if (elementColors.size() < end) {
+        elementColors.resize(end, sf::Color::White);
+    }
+
+    std::fill(elementColors.begin() + begin, elementColors.begin() + end, color);
+}
 
-        std::swap(array[i], array[rand]);
-        visualize(array, delay, i, rand);
+// counts a comparison and spends the artificial comparator work on it
+void countComparison() {
+    comparisonCount++;
+    for (int i = 0; i < comparisonWork; i++) {
+        comparisonSink = i;
     }
 }
 
-void bubbleSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(10)) {
+bool lessThan(int a, int b) {
+    countComparison();
+    if (activeAdversary != nullptr) {
+        return activeAdversary->less(a - 1, b - 1);
+    }
+    return a < b;
+}
 
-    for (int i = 0; i < array.size(); i++) {
+// Instrumentation policies of the generic algorithms, fixed at compile time so that NoInstrumentation compiles to the
+// plain algorithm: Visualized counts and draws (unless headless), Counted only counts, NoInstrumentation does neither.
+struct Visualized {
+    static constexpr bool counts = true;
+    static constexpr bool draws = true;
+};
 
-        int lastSwapIndex = 0; // for visualization
+struct Counted {
+    static constexpr bool counts = true;
+    static constexpr bool draws = false;
+};
 
-        for (int j = 0; j < array.size() - i - 1; j++) {
-            if (array[j] > array[j + 1]) {
-                std::swap(array[j], array[j + 1]);
-                lastSwapIndex = j;
+struct NoInstrumentation {
+    static constexpr bool counts = false;
+    static constexpr bool draws = false;
+};
+
+// Comparison of the generic algorithms: compares the projected keys of two elements (C++20 ranges style) and carries
+// the instrumentation policy of the algorithm. The default orders and counts ints exactly like lessThan().
+template<typename Projection = std::identity, typename Compare = std::ranges::less, typename Instrumentation = Visualized>
+struct KeyLess {
+    using Policy = Instrumentation;
+
+    [[no_unique_address]] Projection projection;
+    [[no_unique_address]] Compare compare;
+
+    template<typename T>
+    bool operator()(const T &a, const T &b) const {
+        if constexpr (Policy::counts && std::is_same_v<T, int> && std::is_same_v<Projection, std::identity>
+                      && std::is_same_v<Compare, std::ranges::less>) {
+            return lessThan(a, b);
+        } else {
+            if constexpr (Policy::counts) {
+                countComparison();
             }
+            return std::invoke(compare, std::invoke(projection, a), std::invoke(projection, b));
         }
+    }
+};
 
-        visualize(array, delay, array.size() - i - 1, lastSwapIndex);
+template<typename Less>
+void countWritesWith(const Less &, long long writes) {
+    if constexpr (Less::Policy::counts) {
+        writeCount += writes;
     }
 }
 
-void insertionSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(10)) {
+template<typename T>
+void swapElements(std::vector<T> &array, int indexA, int indexB) {
+    std::swap(array[indexA], array[indexB]);
+    writeCount += 2;
+}
 
-    for (int i = 1; i < array.size(); i++) {
+template<typename T, typename Less>
+void swapElements(std::vector<T> &array, int indexA, int indexB, const Less &less) {
+    std::swap(array[indexA], array[indexB]);
+    countWritesWith(less, 2);
+}
 
-        int j;
-        for (j = i; j > 0 && array[j] < array[j - 1]; j--) {
-            std::swap(array[j], array[j - 1]);
-        }
+// xoshiro256** (Blackman and Vigna), seeded through splitmix64. Much faster than std::mt19937 and jump() splits it
+// into non-overlapping streams for parallel generation.
+struct Xoshiro256 {
+    using result_type = std::uint64_t;
+
+    std::uint64_t state[4];
 
-        visualize(array, delay, j - 1, i);
+    explicit Xoshiro256(std::uint64_t seed) {
+        for (std::uint64_t &word: state) {
+            seed += 0x9e3779b97f4a7c15;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
     }
-}
 
-void selectionSort(std::vector<int> &array, sf::Time delay = sf::microseconds(25)) {
+    static constexpr result_type min() { return 0; }
 
-    for (int i = 0; i < array.size(); i++) {
+    static constexpr result_type max() { return ~0ull; }
 
-        int minIndex = i;
-        for (int j = i + 1; j < array.size(); j++) {
-            if (array[j] < array[minIndex]) {
-                minIndex = j;
+    result_type operator()() {
+        std::uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+        std::uint64_t shifted = state[1] << 17;
 
-                visualize(array, delay, i, minIndex);
-            }
-            visualize(array, delay, i, j);
-        }
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = std::rotl(state[3], 45);
 
-        std::swap(array[i], array[minIndex]);
-        visualize(array, delay, i, minIndex);
+        return result;
     }
-}
 
-void heapSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+    // advances the generator by 2^128 steps
+    void jump() {
+        static constexpr std::uint64_t polynomial[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                                                       0x39abdc4529b1661c};
 
-    for (int i = 1; i < array.size(); i++) {
+        std::uint64_t jumped[4] = {};
+        for (std::uint64_t word: polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (word & 1ull << bit) {
+                    for (int i = 0; i < 4; i++) {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        std::copy(jumped, jumped + 4, state);
+    }
+};
 
-        int childIndex = i;
-        int parentIndex = (childIndex - 1) / 2;
+// consumers of the seed, each drawing from its own stream so that none replays the numbers of another
+enum class RandomStream : std::uint64_t {
+    Values,
+    Shuffle,
+    Swaps,
+    Splitters,
+};
 
-        while (array[childIndex] < array[parentIndex]) {
-            std::swap(array[childIndex], array[parentIndex]);
-            visualize(array, delay, childIndex, parentIndex);
+// generator of one consumer, seeded with randomSeed mixed with the consumer
+Xoshiro256 randomStream(RandomStream stream) {
+    return Xoshiro256(randomSeed + (std::uint64_t) stream * 0xd1b54a32d192ed03);
+}
+
+// uniform in [0, bound) without modulo bias (Lemire's multiply and reject)
+std::uint32_t randomBelow(Xoshiro256 &generator, std::uint32_t bound) {
 
-            childIndex = parentIndex;
-            parentIndex = (childIndex - 1) / 2;
+    std::uint64_t product = (generator() >> 32) * bound;
+    if ((std::uint32_t) product < bound) {
+        std::uint32_t threshold = -bound % bound;
+        while ((std::uint32_t) product < threshold) {
+            product = (generator() >> 32) * bound;
         }
     }
 
-    for (int i = array.size() - 1; i > 0; i--) {
+    return product >> 32;
+}
 
-        std::swap(array[0], array[i]);
-        visualize(array, delay, 0, i);
+// Fisher-Yates shuffle, every permutation is equally likely for a given seed
+void shuffle(std::vector<int> &array, sf::Time delay = sf::milliseconds(1)) {
 
-        int parentIndex = 0;
-        int leftChildIndex = 2 * parentIndex + 1;
-        int rightChildIndex = 2 * parentIndex + 2;
+    Xoshiro256 generator = randomStream(RandomStream::Shuffle);
 
-        while (leftChildIndex < i) {
+    for (int i = array.size() - 1; i > 0; i--) {
+        int index = randomBelow(generator, i + 1);
 
-            int minIndex = parentIndex;
+        std::swap(array[i], array[index]);
+        visualize(array, delay, i, index);
+    }
+}
 
-            if (array[leftChildIndex] < array[minIndex]) {
-                minIndex = leftChildIndex;
-            }
+#ifdef __linux__
+// affinity of the process before pinToCore, if it pinned the calling thread
+cpu_set_t unpinnedAffinity;
+bool pinnedToCore = false;
+#endif
 
-            if (rightChildIndex < i && array[rightChildIndex] < array[minIndex]) {
-                minIndex = rightChildIndex;
-            }
+// gives a worker of parallelFor the affinity from before pinToCore, so only the measuring thread stays pinned
+void unpinWorker() {
+#ifdef __linux__
+    if (pinnedToCore) {
+        sched_setaffinity(0, sizeof(unpinnedAffinity), &unpinnedAffinity);
+    }
+#endif
+}
 
-            if (minIndex == parentIndex) {
-                break;
-            }
+// runs task(0) to task(taskCount - 1) on threadCount threads. While visualizing the tasks run one after another on
+// the calling thread because only the main thread may draw.
+void parallelFor(int taskCount, const std::function<void(int)> &task) {
 
-            std::swap(array[parentIndex], array[minIndex]);
-            visualize(array, delay, parentIndex, minIndex);
+    int workerCount = headless ? std::min(threadCount, taskCount) : 1;
 
-            parentIndex = minIndex;
-            leftChildIndex = 2 * parentIndex + 1;
-            rightChildIndex = 2 * parentIndex + 2;
+    if (workerCount <= 1) {
+        for (int i = 0; i < taskCount; i++) {
+            task(i);
         }
+        return;
+    }
+
+    std::atomic<int> nextTask = 0;
+    std::atomic<unsigned long long> comparisons = 0;
+    std::atomic<unsigned long long> writes = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back([&]() {
+            unpinWorker();
+
+            for (int taskIndex = nextTask++; taskIndex < taskCount; taskIndex = nextTask++) {
+                task(taskIndex);
+            }
+
+            comparisons += comparisonCount;
+            writes += writeCount;
+        });
     }
 
-    for (int i = 0; i < array.size() / 2; i++) {
-        std::swap(array[i], array[array.size() - i - 1]);
-        visualize(array, delay, i, array.size() - i - 1);
+    for (std::thread &worker: workers) {
+        worker.join();
     }
+
+    comparisonCount += comparisons;
+    writeCount += writes;
 }
 
-void mergeSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+// Fills count ints with uniform values in [minValue, maxValue] without visualization. Every block of 2^20 values
+// comes from its own stream, one jump() after the previous block's, so the values only depend on the generator and
+// not on the thread count. Leaves streams jumped past the last block to continue the sequence.
+void fillRandom(int *data, long long count, int minValue, int maxValue, Xoshiro256 &streams) {
 
-    std::vector<int> temp(array.size());
+    const long long blockSize = 1 << 20;
+    int blockCount = (count + blockSize - 1) / blockSize;
 
-    for (int width = 1; width < array.size(); width *= 2) {
+    std::vector<Xoshiro256> blockStreams;
+    for (int block = 0; block < blockCount; block++) {
+        blockStreams.push_back(streams);
+        streams.jump();
+    }
 
-        for (int i = 0; i < array.size(); i += 2 * width) {
+    std::uint32_t range = (std::uint32_t) maxValue - (std::uint32_t) minValue + 1;
 
-            int left = i;
-            int middle = std::min(i + width, (int) array.size());
-            int right = std::min(i + 2 * width, (int) array.size());
+    parallelFor(blockCount, [&](int block) {
+        Xoshiro256 generator = blockStreams[block];
+        long long end = std::min(count, (block + 1) * blockSize);
+        for (long long i = block * blockSize; i < end; i++) {
+            data[i] = minValue + (int) randomBelow(generator, range);
+        }
+    });
+}
 
-            int leftIndex = left;
-            int rightIndex = middle;
+void randomSwaps(std::vector<int> &array, int swapCount, sf::Time delay = sf::milliseconds(1)) {
 
-            for (int j = left; j < right; j++) {
+    Xoshiro256 generator = randomStream(RandomStream::Swaps);
 
-                if (leftIndex < middle && (rightIndex >= right || array[leftIndex] < array[rightIndex])) {
-                    temp[j] = array[leftIndex];
-                    leftIndex++;
-                } else {
-                    temp[j] = array[rightIndex];
-                    rightIndex++;
-                }
+    for (int i = 0; i < swapCount; i++) {
+        int indexA = randomBelow(generator, array.size());
+        int indexB = randomBelow(generator, array.size());
+
+        std::swap(array[indexA], array[indexB]);
+        visualize(array, delay, indexA, indexB);
+    }
+}
+
+template<typename T, typename Less = KeyLess<>>
+void bubbleSort(std::vector<T> &array, sf::Time delay = sf::milliseconds(10), Less less = {}) {
+
+    for (int i = 0; i < array.size(); i++) {
+
+        int lastSwapIndex = 0; // for visualization
 
-                visualize(array, delay, j);
+        for (int j = 0; j < array.size() - i - 1; j++) {
+            if (less(array[j + 1], array[j])) {
+                swapElements(array, j, j + 1, less);
+                lastSwapIndex = j;
             }
         }
 
-        writeVisualize(temp, array, delay);
-        visualize(array, sf::Time::Zero);
+        visualizeWith(less, array, delay, array.size() - i - 1, lastSwapIndex);
     }
 }
 
-void radixSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+template<typename T, typename Less = KeyLess<>>
+void insertionSort(std::vector<T> &array, sf::Time delay = sf::milliseconds(10), Less less = {}) {
 
-    std::vector<int> temp(array.size());
+    for (int i = 1; i < array.size(); i++) {
 
-    int maxElement = *std::max_element(array.begin(), array.end());
+        int j;
+        for (j = i; j > 0 && less(array[j], array[j - 1]); j--) {
+            swapElements(array, j, j - 1, less);
+        }
 
-    for (int exp = 1; maxElement / exp > 0; exp *= 10) {
+        visualizeWith(less, array, delay, j - 1, i);
+    }
+}
 
-        std::vector<int> count(10);
+// inserts array[index] into the sorted range [begin, index) behind any equal elements, shifting with one move
+template<typename T, typename Less = KeyLess<>>
+void binaryInsert(std::vector<T> &array, int begin, int index, sf::Time delay, Less less = {}) {
 
-        for (int i: array) {
-            count[(i / exp) % 10]++;
-        }
+    T value = std::move(array[index]);
 
-        for (int i = 1; i < count.size(); i++) {
-            count[i] += count[i - 1];
+    int left = begin;
+    int right = index;
+    while (left < right) {
+        int middle = left + (right - left) / 2;
+        if (less(value, array[middle])) {
+            right = middle;
+        } else {
+            left = middle + 1;
         }
+    }
 
-        for (int i = array.size() - 1; i >= 0; i--) {
-            temp[count[(array[i] / exp) % 10] - 1] = array[i];
-            count[(array[i] / exp) % 10]--;
-        }
+    if (left == index) {
+        array[index] = std::move(value);
+        visualizeWith(less, array, delay, left, index);
+        return;
+    }
 
-        writeVisualize(temp, array, delay);
-        visualize(array, sf::Time::Zero);
+    std::move_backward(array.begin() + left, array.begin() + index, array.begin() + index + 1);
+    array[left] = std::move(value);
+    countWritesWith(less, index - left + 1);
+
+    visualizeWith(less, array, delay, left, index);
+}
+
+template<typename T, typename Less = KeyLess<>>
+void binaryInsertionSortRange(std::vector<T> &array, int begin, int end, sf::Time delay, Less less = {}) {
+    for (int i = begin + 1; i < end; i++) {
+        binaryInsert(array, begin, i, delay, less);
     }
 }
 
-int main() {
+template<typename T, typename Less = KeyLess<>>
+void binaryInsertionSort(std::vector<T> &array, sf::Time delay = sf::milliseconds(10), Less less = {}) {
+    binaryInsertionSortRange(array, 0, array.size(), delay, less);
+}
 
-    // create window
-    window.create(sf::VideoMode(screenWidth / 2, screenHeight / 2), "sorting");
+// Ford-Johnson: sorts ids (indices into array) and returns the sorted order as positions into ids.
+// Winners of pairwise comparisons are sorted recursively, then the losers are binary inserted in
+// Jacobsthal order so every search runs over at most 2^k - 1 elements.
+std::vector<int> mergeInsertionOrder(std::vector<int> &array, const std::vector<int> &ids, sf::Time delay) {
 
-    // initialize ImGui
-    if (!ImGui::SFML::Init(window))
-        return 1;
+    int n = ids.size();
+    if (n < 2) {
+        return std::vector<int>(n, 0);
+    }
 
-    // load sound
-    if (!soundBuffer.loadFromFile("sort.wav"))
-        return 1;
+    auto idLess = [&](int positionA, int positionB) {
+        visualize(array, delay, ids[positionA], ids[positionB]);
+        return lessThan(array[ids[positionA]], array[ids[positionB]]);
+    };
 
-    highlightSoundA.setBuffer(soundBuffer);
-    highlightSoundB.setBuffer(soundBuffer);
-    highlightSoundA.setVolume(10);
-    highlightSoundB.setVolume(10);
-    highlightSoundA.setLoop(true);
-    highlightSoundB.setLoop(true);
+    int pairCount = n / 2;
+    std::vector<int> winners(pairCount);
+    std::vector<int> losers(pairCount);
+    for (int pair = 0; pair < pairCount; pair++) {
+        bool firstLess = idLess(2 * pair, 2 * pair + 1);
+        winners[pair] = firstLess ? 2 * pair + 1 : 2 * pair;
+        losers[pair] = firstLess ? 2 * pair : 2 * pair + 1;
+    }
 
-    // initialize array
-    int arraySize = 256;
-    int lastArraySize = arraySize;
+    std::vector<int> winnerIds(pairCount);
+    for (int pair = 0; pair < pairCount; pair++) {
+        winnerIds[pair] = ids[winners[pair]];
+    }
+    std::vector<int> sortedPairs = mergeInsertionOrder(array, winnerIds, delay);
 
-    std::vector<int> array = std::vector<int>(arraySize);
-    for (int i = 0; i < array.size(); i++) {
-        array[i] = i + 1;
+    // main chain: b1 a1 a2 ... with a sorted, b1 is smaller than a1 so it needs no search
+    std::vector<int> chain;
+    chain.reserve(n);
+    chain.push_back(losers[sortedPairs[0]]);
+    for (int pair: sortedPairs) {
+        chain.push_back(winners[pair]);
     }
 
-    // main loop
-    while (window.isOpen()) {
+    // pending b2 ... bm, plus the unpaired last element of an odd count
+    int pendCount = pairCount + (n % 2);
+    auto insertPending = [&](int b) {
+        int item = b < pairCount ? losers[sortedPairs[b]] : n - 1;
 
-        // limit framerate to 30 to reduce CPU/GPU usage in controls window
-        window.setFramerateLimit(30);
+        // b is smaller than its partner, so only the chain in front of it is searched
+        int end = chain.size();
+        if (b < pairCount) {
+            end = std::find(chain.begin(), chain.end(), winners[sortedPairs[b]]) - chain.begin();
+        }
 
-        // handle events
-        sf::Event event{};
-        while (window.pollEvent(event)) {
-            ImGui::SFML::ProcessEvent(event);
-            switch (event.type) {
-                case sf::Event::Closed:
-                    window.close();
-                case sf::Event::Resized:
-                    window.setView(sf::View(sf::FloatRect(0, 0, event.size.width, event.size.height)));
+        int begin = 0;
+        while (begin < end) {
+            int middle = begin + (end - begin) / 2;
+            if (idLess(item, chain[middle])) {
+                end = middle;
+            } else {
+                begin = middle + 1;
             }
         }
-        ImGui::SFML::Update(window, deltaClock.restart());
+        chain.insert(chain.begin() + begin, item);
+    };
 
-        // start of controls window
-        ImGui::Begin("Controls", nullptr, ImGuiWindowFlags_NoCollapse);
+    // groups end at the Jacobsthal numbers 3, 5, 11, 21, ... (1-based), each inserted back to front
+    int groupEnd = 1;
+    int previousJacobsthal = 1;
+    int jacobsthal = 3;
+    while (groupEnd < pendCount) {
+        int groupStart = groupEnd;
+        groupEnd = std::min(jacobsthal, pendCount);
+        for (int b = groupEnd - 1; b >= groupStart; b--) {
+            insertPending(b);
+        }
 
-        // algorithm combo box items
-        const char *algorithms[] = {
-                "Bubble Sort",
-                "Insertion Sort",
-                "Selection Sort",
-                "Heap Sort",
-                "Merge Sort",
-                "Radix Sort",
-        };
+        int next = jacobsthal + 2 * previousJacobsthal;
+        previousJacobsthal = jacobsthal;
+        jacobsthal = next;
+    }
 
-        // algorithm combo box
-        static int algorithm = 0;
-        ImGui::Combo("Algorithm", &algorithm, algorithms, IM_ARRAYSIZE(algorithms));
+    return chain;
+}
 
-        // array size input
-        ImGui::InputInt("Array Size", &arraySize, 1, 4);
-        arraySize = std::max(2, std::min(arraySize, 1024));
+// close to the minimum possible number of comparisons, pays off when comparisons are expensive
+void mergeInsertionSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(5)) {
 
-        // resize array if array size changed
-        if (arraySize != lastArraySize) {
-            array = std::vector<int>(arraySize);
-            for (int i = 0; i < array.size(); i++) {
-                array[i] = i + 1;
+    std::vector<int> ids(array.size());
+    for (int i = 0; i < ids.size(); i++) {
+        ids[i] = i;
+    }
+
+    std::vector<int> order = mergeInsertionOrder(array, ids, delay);
+
+    std::vector<int> sorted(array.size());
+    for (int i = 0; i < order.size(); i++) {
+        sorted[i] = array[order[i]];
+    }
+    writeVisualize(sorted, array, delay);
+}
+
+template<typename T, typename Less = KeyLess<>>
+void selectionSort(std::vector<T> &array, sf::Time delay = sf::microseconds(25), Less less = {}) {
+
+    for (int i = 0; i < array.size(); i++) {
+
+        int minIndex = i;
+        for (int j = i + 1; j < array.size(); j++) {
+            if (less(array[j], array[minIndex])) {
+                minIndex = j;
+
+                visualizeWith(less, array, delay, i, minIndex);
             }
-            lastArraySize = arraySize;
+            visualizeWith(less, array, delay, i, j);
         }
 
-        // visualize button
-        if (ImGui::Button("Visualize", ImVec2(100, 20))) {
-            ImGui::End(); // end controls window early because it is unneeded during visualization
+        // skip swapping an element with itself so writes stay at most 2 * (n - 1)
+        if (minIndex != i) {
+            swapElements(array, i, minIndex, less);
+        }
+        visualizeWith(less, array, delay, i, minIndex);
+    }
+}
 
-            // finish rendering controls window
-            window.clear();
-            ImGui::SFML::Render(window);
-            window.display();
+// final position of item: cycleStart plus the number of smaller elements to its right
+int cyclePosition(std::vector<int> &array, int cycleStart, int item, sf::Time delay) {
 
-            // remove framerate limit for sorting as it limits the speed of the sorting (disadvantage of single thread)
-            window.setFramerateLimit(0);
+    int position = cycleStart;
+    for (int i = cycleStart + 1; i < array.size(); i++) {
+        if (lessThan(array[i], item)) {
+            position++;
+        }
+        visualize(array, delay, cycleStart, i);
+    }
 
-            sleepRatio = arraySize / 1024.0;
+    return position;
+}
 
-            try {
+// writes every element at most once, directly into its final position, so it never exceeds n writes
+void cycleSort(std::vector<int> &array, sf::Time delay = sf::microseconds(25)) {
 
-                visualizeWait(array, sf::seconds(1));
+    for (int cycleStart = 0; cycleStart + 1 < array.size(); cycleStart++) {
 
-                shuffle(array);
+        int item = array[cycleStart];
 
-                visualizeWait(array, sf::seconds(1));
+        // already in place, the cycle is empty
+        int position = cyclePosition(array, cycleStart, item, delay);
+        if (position == cycleStart) {
+            continue;
+        }
 
-                switch (algorithm) {
-                    case 0:
-                        bubbleSort(array);
-                        break;
-                    case 1:
-                        insertionSort(array);
-                        break;
-                    case 2:
-                        selectionSort(array);
-                        break;
-                    case 3:
-                        heapSort(array);
-                        break;
-                    case 4:
-                        mergeSort(array);
-                        break;
-                    case 5:
-                        radixSort(array);
-                        break;
-                    default:
-                        break;
-                }
+        // rotate the cycle, carrying the displaced element to its position each time
+        while (true) {
 
-                visualizeWait(array, sf::seconds(1));
+            // place after elements equal to item so duplicates do not swap back and forth
+            while (position != cycleStart && !lessThan(item, array[position]) && !lessThan(array[position], item)) {
+                position++;
+            }
+            std::swap(item, array[position]);
+            writeCount++;
+            visualize(array, delay, position);
 
-            } catch (std::exception &e) {
-                // do nothing because exception is thrown by stop button
+            if (position == cycleStart) {
+                break;
             }
+            position = cyclePosition(array, cycleStart, item, delay);
+        }
+    }
+}
+
+enum class GapSequence {
+    Shell,     // n/2, n/4, ..., 1
+    Knuth,     // (3^k - 1) / 2
+    Sedgewick, // 4^k + 3 * 2^(k-1) + 1
+    Tokuda,    // ceil((9 * (9/4)^(k-1) - 4) / 5)
+    Ciura,     // measured up to 701, then extended by a factor of 2.25
+};
+
+// gaps smaller than size in decreasing order, always ending with 1
+std::vector<int> shellSortGaps(GapSequence sequence, int size) {
+
+    std::vector<long long> gaps;
+
+    switch (sequence) {
+        case GapSequence::Shell:
+            for (long long gap = size / 2; gap > 1; gap /= 2) {
+                gaps.push_back(gap);
+            }
+            gaps.push_back(1);
+            std::reverse(gaps.begin(), gaps.end());
+            break;
+        case GapSequence::Knuth:
+            for (long long gap = 1; gap < size; gap = 3 * gap + 1) {
+                gaps.push_back(gap);
+            }
+            break;
+        case GapSequence::Sedgewick:
+            gaps.push_back(1);
+            for (long long power = 1; 4 * power * power + 3 * power + 1 < size; power *= 2) {
+                gaps.push_back(4 * power * power + 3 * power + 1);
+            }
+            break;
+        case GapSequence::Tokuda:
+            for (double term = 1; std::ceil(term) < size; term = term * 2.25 + 1) {
+                gaps.push_back((long long) std::ceil(term));
+            }
+            break;
+        case GapSequence::Ciura:
+            gaps.push_back(1);
+            for (long long gap: {4, 10, 23, 57, 132, 301, 701}) {
+                if (gap < size) {
+                    gaps.push_back(gap);
+                }
+            }
+            while (gaps.back() >= 701 && gaps.back() * 9 / 4 < size) {
+                gaps.push_back(gaps.back() * 9 / 4);
+            }
+            break;
+    }
+
+    if (gaps.empty()) {
+        gaps.push_back(1);
+    }
+
+    return std::vector<int>(gaps.rbegin(), gaps.rend());
+}
+
+template<typename T, typename Less = KeyLess<>>
+void shellSort(std::vector<T> &array, GapSequence sequence, sf::Time delay = sf::milliseconds(2), Less less = {}) {
+
+    int size = array.size();
+
+    for (int gap: shellSortGaps(sequence, size)) {
+
+        // show which elements form one of the gap's chains at the start of each h-sorting pass
+        if (!headless) {
+            std::vector<int> chain;
+            for (int i = 0; i < size; i += gap) {
+                chain.push_back(i);
+            }
+            visualizeBatchWith(less, array, sf::milliseconds(250), chain);
+        }
+
+        for (int i = gap; i < size; i++) {
+
+            T value = std::move(array[i]);
+
+            int j;
+            for (j = i; j >= gap && less(value, array[j - gap]); j -= gap) {
+                array[j] = std::move(array[j - gap]);
+                countWritesWith(less, 1);
+            }
+
+            array[j] = std::move(value);
+            if (j != i) {
+                countWritesWith(less, 1);
+            }
+
+            visualizeWith(less, array, delay, j, i);
+        }
+    }
+}
+
+// Heap helpers work on a heap rooted at array[begin], heap indices are relative to begin.
+
+// descends from index to a leaf, always following the largest child (one comparison per level for arity 2)
+template<int arity, typename T, typename Less>
+int heapLeafSearch(std::vector<T> &array, int begin, int index, int end, sf::Time delay, Less less) {
+
+    int leafIndex = index;
+
+    while (arity * leafIndex + 1 < end) {
+
+        int firstChild = arity * leafIndex + 1;
+        int lastChild = std::min(firstChild + arity, end);
+
+        int maxChild = firstChild;
+        for (int child = firstChild + 1; child < lastChild; child++) {
+            if (less(array[begin + maxChild], array[begin + child])) {
+                maxChild = child;
+            }
+        }
+
+        leafIndex = maxChild;
+        visualizeWith(less, array, delay, begin + index, begin + leafIndex);
+    }
+
+    return leafIndex;
+}
+
+// bottom-up sift down (Wegener): find the leaf path first, then climb back to where the element at index belongs
+template<int arity, typename T, typename Less>
+void heapSiftDown(std::vector<T> &array, int begin, int index, int end, sf::Time delay, Less less) {
+
+    int targetIndex = heapLeafSearch<arity>(array, begin, index, end, delay, less);
+
+    while (targetIndex > index && less(array[begin + targetIndex], array[begin + index])) {
+        targetIndex = (targetIndex - 1) / arity;
+    }
+
+    if (targetIndex == index) {
+        return;
+    }
+
+    // rotate the element at index into targetIndex, shifting the path above it up by one level
+    T value = std::move(array[begin + targetIndex]);
+    array[begin + targetIndex] = std::move(array[begin + index]);
+    countWritesWith(less, 1);
+    visualizeWith(less, array, delay, begin + targetIndex, begin + index);
+
+    while (targetIndex > index) {
+        int parentIndex = (targetIndex - 1) / arity;
+
+        std::swap(value, array[begin + parentIndex]);
+        countWritesWith(less, 1);
+        visualizeWith(less, array, delay, begin + parentIndex, begin + targetIndex);
+
+        targetIndex = parentIndex;
+    }
+}
+
+// max-heap built with Floyd's heapify, extracted to the back so no final reversal is needed
+template<int arity, typename T, typename Less = KeyLess<>>
+void dAryHeapSort(std::vector<T> &array, int begin, int end, sf::Time delay, Less less = {}) {
+
+    int size = end - begin;
+
+    for (int i = (size - 2) / arity; i >= 0; i--) {
+        heapSiftDown<arity>(array, begin, i, size, delay, less);
+    }
+
+    for (int last = size - 1; last > 0; last--) {
+
+        swapElements(array, begin, begin + last, less);
+        visualizeWith(less, array, delay, begin, begin + last);
+
+        heapSiftDown<arity>(array, begin, 0, last, delay, less);
+    }
+}
+
+template<typename T, typename Less = KeyLess<>>
+void heapSort(std::vector<T> &array, sf::Time delay = sf::microseconds(500), Less less = {}) {
+    dAryHeapSort<2>(array, 0, array.size(), delay, less);
+}
+
+template<typename T, typename Less = KeyLess<>>
+void quaternaryHeapSort(std::vector<T> &array, sf::Time delay = sf::microseconds(500), Less less = {}) {
+    dAryHeapSort<4>(array, 0, array.size(), delay, less);
+}
+
+// headless report of the merge sorts: every pass over memory reads and writes each element once
+template<typename T>
+void reportMemoryPasses(int passes) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "  %d passes over memory, %d bytes moved per element", passes,
+                  passes * 2 * (int) sizeof(T));
+    sortReport.emplace_back(line);
+}
+
+// Bottom-up pairwise merging of the sorted runs of length width in [begin, end), with temp[begin, end) as buffer.
+// Returns the number of passes over the range, including the copy back when the result ends up in temp.
+template<typename T, typename Less = KeyLess<>>
+int mergePasses(std::vector<T> &array, std::vector<T> &temp, int begin, int end, int width, sf::Time delay,
+                Less less = {}) {
+
+    int passes = 0;
+
+    // merge passes alternate between the two buffers instead of copying every pass back
+    std::vector<T> *src = &array;
+    std::vector<T> *dst = &temp;
+
+    for (; width < end - begin; width *= 2) {
+
+        for (int i = begin; i < end; i += 2 * width) {
+
+            int left = i;
+            int middle = std::min(i + width, end);
+            int right = std::min(i + 2 * width, end);
+
+            int leftIndex = left;
+            int rightIndex = middle;
+
+            for (int j = left; j < right; j++) {
+
+                if (leftIndex < middle && (rightIndex >= right || !less((*src)[rightIndex], (*src)[leftIndex]))) {
+                    (*dst)[j] = (*src)[leftIndex];
+                    leftIndex++;
+                } else {
+                    (*dst)[j] = (*src)[rightIndex];
+                    rightIndex++;
+                }
+                countWritesWith(less, 1);
+
+                // temp holds stale data outside the merged prefix, so the array stays on screen
+                visualizeWith(less, array, delay, j);
+            }
+        }
+
+        std::swap(src, dst);
+        visualizeWith(less, array, sf::Time::Zero);
+        passes++;
+    }
+
+    // an odd number of passes leaves the sorted data in temp
+    if (src != &array) {
+        for (int i = begin; i < end; i++) {
+            array[i] = temp[i];
+            countWritesWith(less, 1);
+            visualizeWith(less, array, delay, i);
+        }
+        visualizeWith(less, array, sf::Time::Zero);
+        passes++;
+    }
+
+    return passes;
+}
+
+// sorts [begin, end) of array with temp[begin, end) as buffer, returns the number of passes over the range
+template<typename T, typename Less = KeyLess<>>
+int mergeSortRange(std::vector<T> &array, std::vector<T> &temp, int begin, int end, sf::Time delay, Less less = {}) {
+
+    const int runSize = 16;
+
+    // insertion sort small runs in place so the merge passes can start at width = runSize
+    for (int left = begin; left < end; left += runSize) {
+        binaryInsertionSortRange(array, left, std::min(left + runSize, end), delay, less);
+    }
+
+    return 1 + mergePasses(array, temp, begin, end, runSize, delay, less);
+}
+
+template<typename T, typename Less = KeyLess<>>
+void mergeSort(std::vector<T> &array, sf::Time delay = sf::microseconds(500), Less less = {}) {
+    std::vector<T> temp(array.size());
+    int passes = mergeSortRange(array, temp, 0, array.size(), delay, less);
+
+    // formatting the report would be timed with the sort, so uninstrumented runs leave it out
+    if constexpr (Less::Policy::counts) {
+        reportMemoryPasses<T>(passes);
+    }
+}
+
+// size in bytes of the data or unified cache of the given level of cpu0, read from sysfs, 0 if unknown
+long long cpuCacheSize(int level) {
+
+    for (int index = 0;; index++) {
+        std::string directory = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+
+        std::ifstream levelFile(directory + "level");
+        if (!levelFile) {
+            return 0;
+        }
+        int cacheLevel = 0;
+        levelFile >> cacheLevel;
+
+        std::string type;
+        std::ifstream(directory + "type") >> type;
+        if (cacheLevel != level || type == "Instruction") {
+            continue;
+        }
+
+        // e.g. "2048K"
+        std::string size;
+        std::ifstream(directory + "size") >> size;
+        long long bytes = std::atoll(size.c_str());
+        if (!size.empty() && size.back() == 'K') {
+            bytes *= 1024;
+        } else if (!size.empty() && size.back() == 'M') {
+            bytes *= 1024 * 1024;
+        }
+        return bytes;
+    }
+}
+
+// elements per tile of cacheMergeSort: a tile and its merge buffer fill half of L2 (256 KiB assumed if unknown)
+const int cacheTileSize = [] {
+    long long bytes = cpuCacheSize(2);
+    if (bytes <= 0) {
+        bytes = 256 * 1024;
+    }
+    return std::max(1024, (int) (bytes / 4 / sizeof(int)));
+}();
+
+// Tournament tree over the k sorted runs of a run source, which provides count(), exhausted(run), head(run) and
+// advance(run). Inner nodes keep the loser of their match, so taking the winner only replays the log2(k) matches
+// on its leaf-to-root path. Ties go to the lower run, which keeps merges of consecutive runs stable.
+// Only for runs of int in their natural order: every head is packed with its run index into one 64-bit key, so the
+// typed and comparator-based sorts cannot use it.
+template<typename Runs>
+struct LoserTree {
+    Runs &runs;
+    std::vector<int> tree; // tree[0] is the winner, tree[1, k) the losers, leaves are the implicit nodes k + run
+
+    // Head of every run with the run index in the low half, kept next to the tree so matches neither chase the
+    // run cursors nor branch on ties: the smaller key wins, equal values go to the lower run, exhausted runs hold
+    // the maximum key and lose every match.
+    std::vector<unsigned long long> key;
+
+    explicit LoserTree(Runs &runs) : runs(runs), tree(runs.count()), key(runs.count()) {
+
+        int k = runs.count();
+        for (int run = 0; run < k; run++) {
+            refill(run);
+        }
+
+        std::vector<int> winner(2 * k);
+        for (int run = 0; run < k; run++) {
+            winner[k + run] = run;
+        }
+        for (int node = k - 1; node > 0; node--) {
+            int a = winner[2 * node];
+            int b = winner[2 * node + 1];
+            bool aWins = beats(a, b);
+            winner[node] = aWins ? a : b;
+            tree[node] = aWins ? b : a;
+        }
+        tree[0] = winner[1];
+    }
+
+    void refill(int run) {
+        if (runs.exhausted(run)) {
+            key[run] = ~0ull;
+        } else {
+            // flipping the sign bit orders negative values first when compared unsigned
+            unsigned int value = (unsigned int) runs.head(run) ^ 0x80000000u;
+            key[run] = (unsigned long long) value << 32 | (unsigned int) run;
+        }
+    }
+
+    bool beats(int a, int b) {
+        countComparison();
+        return key[a] < key[b];
+    }
+
+    // removes and returns the smallest remaining element, only valid while elements remain
+    int pop() {
+        int k = tree.size();
+        int winner = tree[0];
+        int value = (int) ((unsigned int) (key[winner] >> 32) ^ 0x80000000u);
+        runs.advance(winner);
+        refill(winner);
+
+        for (int node = (winner + k) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+
+        return value;
+    }
+};
+
+// k sorted ranges src[cursor, end) of one array as run source of a LoserTree
+struct ArrayRuns {
+    std::vector<int> &src;
+    std::vector<int> cursor;
+    std::vector<int> end;
+
+    int count() const { return cursor.size(); }
+
+    bool exhausted(int run) const { return cursor[run] == end[run]; }
+
+    int head(int run) const { return src[cursor[run]]; }
+
+    void advance(int run) { cursor[run]++; }
+};
+
+// Merges the consecutive sorted runs src[runBegin[i], runEnd[i]) into dst[runBegin.front(), runEnd.back()) in one
+// pass. The visualizer highlights the heads of all runs as k cursors advancing through the input.
+void multiwayMerge(std::vector<int> &src, std::vector<int> &dst, const std::vector<int> &runBegin,
+                   const std::vector<int> &runEnd, sf::Time delay) {
+
+    ArrayRuns runs{src, runBegin, runEnd};
+    LoserTree<ArrayRuns> loserTree(runs);
+
+    for (int j = runBegin.front(); j < runEnd.back(); j++) {
+        dst[j] = loserTree.pop();
+        writeCount++;
+
+        if (!headless) {
+            highlightedIndices.clear();
+            for (int run = 0; run < runs.count(); run++) {
+                if (!runs.exhausted(run)) {
+                    highlightedIndices.push_back(runs.cursor[run]);
+                }
+            }
+            visualize(dst, delay, j);
+        }
+    }
+
+    highlightedIndices.clear();
+}
+
+// runs merged at once by cacheMergeSort, their cursors' cache lines stay well inside L1
+const int cacheMergeFanIn = 64;
+
+// Sorts L2 sized tiles with mergeSortRange while they are in cache, then merges up to 64 tiles per pass with a
+// loser tree, so the array streams through DRAM 1 + log64(tiles) times instead of log2(n / 16) times.
+void cacheMergeSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+
+    int size = array.size();
+
+    // the visualizer's arrays fit into one tile, shrink tiles there so the multiway merge is visible
+    int tileSize = headless ? cacheTileSize : std::max(16, size / 16);
+    int fanIn = headless ? cacheMergeFanIn : 4;
+
+    std::vector<int> temp(size);
+    int passes = 1;
+
+    for (int begin = 0, tile = 0; begin < size; begin += tileSize, tile++) {
+        int end = std::min(begin + tileSize, size);
+        mergeSortRange(array, temp, begin, end, delay);
+        colorRange(begin, end, segmentColors[tile % IM_ARRAYSIZE(segmentColors)]);
+    }
+
+    std::vector<int> *src = &array;
+    std::vector<int> *dst = &temp;
+
+    for (long long runSize = tileSize; runSize < size; runSize *= fanIn) {
+
+        for (long long groupBegin = 0; groupBegin < size; groupBegin += runSize * fanIn) {
+
+            std::vector<int> runBegin;
+            std::vector<int> runEnd;
+            for (long long begin = groupBegin; begin < std::min(groupBegin + runSize * fanIn, (long long) size);
+                 begin += runSize) {
+                runBegin.push_back(begin);
+                runEnd.push_back(std::min(begin + runSize, (long long) size));
+            }
+
+            multiwayMerge(*src, *dst, runBegin, runEnd, delay);
+            colorRange(runBegin.front(), runEnd.back(), sf::Color::White);
+        }
+
+        std::swap(src, dst);
+        visualize(*src, sf::Time::Zero);
+        passes++;
+    }
+
+    if (src != &array) {
+        writeVisualize(temp, array, delay);
+        visualize(array, sf::Time::Zero);
+        passes++;
+    }
+
+    reportMemoryPasses<int>(passes);
+}
+
+const int timSortMinGallop = 7;
+
+int timSortMinRun(int size) {
+    int remainder = 0;
+    while (size >= 64) {
+        remainder |= size & 1;
+        size >>= 1;
+    }
+    return size + remainder;
+}
+
+// leftmost position in src[base, base + length) where key could be inserted, searching outwards from hint
+int gallopLeft(int key, std::vector<int> &src, int base, int length, int hint) {
+
+    int lastOffset = 0;
+    int offset = 1;
+
+    if (lessThan(src[base + hint], key)) {
+        int maxOffset = length - hint;
+        while (offset < maxOffset && lessThan(src[base + hint + offset], key)) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = std::min(offset, maxOffset);
+
+        lastOffset += hint;
+        offset += hint;
+    } else {
+        int maxOffset = hint + 1;
+        while (offset < maxOffset && !lessThan(src[base + hint - offset], key)) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = std::min(offset, maxOffset);
+
+        int tmp = lastOffset;
+        lastOffset = hint - offset;
+        offset = hint - tmp;
+    }
+
+    // src[base + lastOffset] < key <= src[base + offset], binary search the rest
+    lastOffset++;
+    while (lastOffset < offset) {
+        int middle = lastOffset + (offset - lastOffset) / 2;
+        if (lessThan(src[base + middle], key)) {
+            lastOffset = middle + 1;
+        } else {
+            offset = middle;
+        }
+    }
+
+    return offset;
+}
+
+// rightmost position in src[base, base + length) where key could be inserted, searching outwards from hint
+int gallopRight(int key, std::vector<int> &src, int base, int length, int hint) {
+
+    int lastOffset = 0;
+    int offset = 1;
+
+    if (lessThan(key, src[base + hint])) {
+        int maxOffset = hint + 1;
+        while (offset < maxOffset && lessThan(key, src[base + hint - offset])) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = std::min(offset, maxOffset);
+
+        int tmp = lastOffset;
+        lastOffset = hint - offset;
+        offset = hint - tmp;
+    } else {
+        int maxOffset = length - hint;
+        while (offset < maxOffset && !lessThan(key, src[base + hint + offset])) {
+            lastOffset = offset;
+            offset = offset * 2 + 1;
+        }
+        offset = std::min(offset, maxOffset);
+
+        lastOffset += hint;
+        offset += hint;
+    }
+
+    // src[base + lastOffset] <= key < src[base + offset], binary search the rest
+    lastOffset++;
+    while (lastOffset < offset) {
+        int middle = lastOffset + (offset - lastOffset) / 2;
+        if (lessThan(key, src[base + middle])) {
+            offset = middle;
+        } else {
+            lastOffset = middle + 1;
+        }
+    }
+
+    return offset;
+}
+
+// merges two adjacent runs with the shorter first run copied to temp, merging from the front
+void timSortMergeLow(std::vector<int> &array, std::vector<int> &temp, int base1, int length1, int base2, int length2,
+                     int &minGallop, sf::Time delay) {
+
+    std::copy(array.begin() + base1, array.begin() + base1 + length1, temp.begin());
+    writeCount += length1;
+
+    int cursor1 = 0; // in temp
+    int cursor2 = base2; // in array
+    int end2 = base2 + length2;
+    int dest = base1;
+
+    while (cursor1 < length1 && cursor2 < end2) {
+
+        int count1 = 0; // number of times in a row the first run won
+        int count2 = 0; // number of times in a row the second run won
+
+        // one element at a time until one run keeps winning
+        while (cursor1 < length1 && cursor2 < end2 && std::max(count1, count2) < minGallop) {
+            if (lessThan(array[cursor2], temp[cursor1])) {
+                array[dest++] = array[cursor2++];
+                count2++;
+                count1 = 0;
+            } else {
+                array[dest++] = temp[cursor1++];
+                count1++;
+                count2 = 0;
+            }
+            writeCount++;
+            visualize(array, delay, dest - 1, cursor2 < end2 ? cursor2 : -1);
+        }
+
+        // galloping mode: move whole stretches found by exponential search
+        while (cursor1 < length1 && cursor2 < end2) {
+
+            count1 = gallopRight(array[cursor2], temp, cursor1, length1 - cursor1, 0);
+            std::copy(temp.begin() + cursor1, temp.begin() + cursor1 + count1, array.begin() + dest);
+            writeCount += count1;
+            dest += count1;
+            cursor1 += count1;
+            visualize(array, delay, dest - 1, cursor2 < end2 ? cursor2 : -1);
+
+            if (cursor1 == length1) {
+                break;
+            }
+
+            count2 = gallopLeft(temp[cursor1], array, cursor2, end2 - cursor2, 0);
+            std::copy(array.begin() + cursor2, array.begin() + cursor2 + count2, array.begin() + dest);
+            writeCount += count2;
+            dest += count2;
+            cursor2 += count2;
+            visualize(array, delay, dest - 1, cursor2 < end2 ? cursor2 : -1);
+
+            minGallop = std::max(minGallop - 1, 1);
+
+            if (count1 < timSortMinGallop && count2 < timSortMinGallop) {
+                break;
+            }
+        }
+
+        // penalize leaving galloping mode
+        minGallop += 2;
+    }
+
+    // whatever is left of the second run is already in place
+    std::copy(temp.begin() + cursor1, temp.begin() + length1, array.begin() + dest);
+    writeCount += length1 - cursor1;
+}
+
+// merges two adjacent runs with the shorter second run copied to temp, merging from the back
+void timSortMergeHigh(std::vector<int> &array, std::vector<int> &temp, int base1, int length1, int base2, int length2,
+                      int &minGallop, sf::Time delay) {
+
+    std::copy(array.begin() + base2, array.begin() + base2 + length2, temp.begin());
+    writeCount += length2;
+
+    int cursor1 = base1 + length1 - 1; // in array
+    int cursor2 = length2 - 1; // in temp
+    int dest = base2 + length2 - 1;
+
+    while (cursor1 >= base1 && cursor2 >= 0) {
+
+        int count1 = 0;
+        int count2 = 0;
+
+        while (cursor1 >= base1 && cursor2 >= 0 && std::max(count1, count2) < minGallop) {
+            if (lessThan(temp[cursor2], array[cursor1])) {
+                array[dest--] = array[cursor1--];
+                count1++;
+                count2 = 0;
+            } else {
+                array[dest--] = temp[cursor2--];
+                count2++;
+                count1 = 0;
+            }
+            writeCount++;
+            visualize(array, delay, dest + 1, cursor1);
+        }
+
+        while (cursor1 >= base1 && cursor2 >= 0) {
+
+            count1 = cursor1 + 1 - base1
+                     - gallopRight(temp[cursor2], array, base1, cursor1 + 1 - base1, cursor1 - base1);
+            std::copy_backward(array.begin() + cursor1 + 1 - count1, array.begin() + cursor1 + 1,
+                               array.begin() + dest + 1);
+            writeCount += count1;
+            dest -= count1;
+            cursor1 -= count1;
+            visualize(array, delay, dest + 1, cursor1);
+
+            if (cursor1 < base1) {
+                break;
+            }
+
+            count2 = cursor2 + 1 - gallopLeft(array[cursor1], temp, 0, cursor2 + 1, cursor2);
+            std::copy_backward(temp.begin() + cursor2 + 1 - count2, temp.begin() + cursor2 + 1,
+                               array.begin() + dest + 1);
+            writeCount += count2;
+            dest -= count2;
+            cursor2 -= count2;
+            visualize(array, delay, dest + 1, cursor1);
+
+            minGallop = std::max(minGallop - 1, 1);
+
+            if (count1 < timSortMinGallop && count2 < timSortMinGallop) {
+                break;
+            }
+        }
+
+        minGallop += 2;
+    }
+
+    // whatever is left of the first run is already in place
+    std::copy_backward(temp.begin(), temp.begin() + cursor2 + 1, array.begin() + dest + 1);
+    writeCount += cursor2 + 1;
+}
+
+void timSortMerge(std::vector<int> &array, std::vector<int> &temp, int base1, int length1, int base2, int length2,
+                  int &minGallop, sf::Time delay) {
+
+    // elements of the first run that are not greater than the second run's first element are already in place
+    int skip = gallopRight(array[base2], array, base1, length1, 0);
+    base1 += skip;
+    length1 -= skip;
+    if (length1 == 0) {
+        return;
+    }
+
+    // likewise for the second run's elements not less than the first run's last element
+    length2 = gallopLeft(array[base1 + length1 - 1], array, base2, length2, length2 - 1);
+    if (length2 == 0) {
+        return;
+    }
+
+    if (length1 <= length2) {
+        timSortMergeLow(array, temp, base1, length1, base2, length2, minGallop, delay);
+    } else {
+        timSortMergeHigh(array, temp, base1, length1, base2, length2, minGallop, delay);
+    }
+}
+
+// node power of the boundary between two adjacent runs in powersort's merge tree
+int powerSortPower(int base1, int length1, int length2, int size) {
+
+    long long a = 2LL * base1 + length1; // twice the midpoint of the first run
+    long long b = a + length1 + length2; // twice the midpoint of the second run
+
+    int power = 0;
+    while (true) {
+        power++;
+        if (a >= size) {
+            a -= size;
+            b -= size;
+        } else if (b >= size) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+
+    return power;
+}
+
+void timSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+
+    struct Run {
+        int base;
+        int length;
+        int power; // power of the boundary to the next run
+    };
+
+    int size = array.size();
+    int minRun = timSortMinRun(size);
+    int minGallop = timSortMinGallop;
+
+    std::vector<int> temp(size / 2 + 1);
+    std::vector<Run> runs;
+    int runNumber = 0;
+
+    // merges the two runs on top of the stack, the merged run takes the color of the lower one
+    auto mergeTopRuns = [&]() {
+        Run &lower = runs[runs.size() - 2];
+        Run &upper = runs.back();
+
+        timSortMerge(array, temp, lower.base, lower.length, upper.base, upper.length, minGallop, delay);
+        lower.length += upper.length;
+        runs.pop_back();
+
+        if (!elementColors.empty()) {
+            colorRange(lower.base, lower.base + lower.length, elementColors[lower.base]);
+        }
+        visualize(array, sf::Time::Zero);
+    };
+
+    for (int base = 0; base < size;) {
+
+        // find the natural run, reversing it if it is strictly descending
+        int runEnd = base + 1;
+        if (runEnd < size) {
+            if (lessThan(array[runEnd], array[base])) {
+                runEnd++;
+                while (runEnd < size && lessThan(array[runEnd], array[runEnd - 1])) {
+                    runEnd++;
+                }
+
+                for (int left = base, right = runEnd - 1; left < right; left++, right--) {
+                    swapElements(array, left, right);
+                    visualize(array, delay, left, right);
+                }
+            } else {
+                runEnd++;
+                while (runEnd < size && !lessThan(array[runEnd], array[runEnd - 1])) {
+                    runEnd++;
+                }
+            }
+        }
+
+        colorRange(base, runEnd, segmentColors[runNumber % IM_ARRAYSIZE(segmentColors)]);
+        runNumber++;
+        visualize(array, delay, base, runEnd - 1);
+
+        // extend short runs to minRun with binary insertion sort
+        int extendedEnd = std::min(base + minRun, size);
+        for (; runEnd < extendedEnd; runEnd++) {
+            colorRange(base, runEnd + 1, segmentColors[(runNumber - 1) % IM_ARRAYSIZE(segmentColors)]);
+            binaryInsert(array, base, runEnd, delay);
+        }
+
+        Run run{base, runEnd - base, 0};
+
+        // merge runs on the stack whose boundary lies deeper in the merge tree than the new one
+        if (!runs.empty()) {
+            int power = powerSortPower(runs.back().base, runs.back().length, run.length, size);
+
+            while (runs.size() > 1 && runs[runs.size() - 2].power > power) {
+                mergeTopRuns();
+            }
+
+            runs.back().power = power;
+        }
+
+        runs.push_back(run);
+        base = runEnd;
+    }
+
+    // merge the remaining runs from the top of the stack
+    while (runs.size() > 1) {
+        mergeTopRuns();
+    }
+
+    elementColors.clear();
+}
+
+const sf::Color blockMergeKeyColor(255, 200, 80);
+const sf::Color blockMergeBufferColor(100, 180, 255);
+
+// swaps two elements together with their colors, so the keys and the buffer stay marked wherever they move
+void blockMergeSwap(std::vector<int> &array, int indexA, int indexB, sf::Time delay) {
+
+    swapElements(array, indexA, indexB);
+
+    if (!elementColors.empty()) {
+        std::swap(elementColors[indexA], elementColors[indexB]);
+    }
+
+    visualize(array, delay, indexA, indexB);
+}
+
+void blockMergeSwapRanges(std::vector<int> &array, int beginA, int beginB, int length, sf::Time delay) {
+    for (int i = 0; i < length; i++) {
+        blockMergeSwap(array, beginA + i, beginB + i, delay);
+    }
+}
+
+// moves [begin + length1, begin + length1 + length2) in front of [begin, begin + length1) with block swaps
+void blockMergeRotate(std::vector<int> &array, int begin, int length1, int length2, sf::Time delay) {
+
+    while (length1 > 0 && length2 > 0) {
+        if (length1 <= length2) {
+            blockMergeSwapRanges(array, begin, begin + length1, length1, delay);
+            begin += length1;
+            length2 -= length1;
+        } else {
+            blockMergeSwapRanges(array, begin + length1 - length2, begin + length1, length2, delay);
+            length1 -= length2;
+        }
+    }
+}
+
+void blockMergeInsertionSort(std::vector<int> &array, int begin, int length, sf::Time delay) {
+    for (int i = begin + 1; i < begin + length; i++) {
+        for (int j = i; j > begin && lessThan(array[j], array[j - 1]); j--) {
+            blockMergeSwap(array, j, j - 1, delay);
+        }
+    }
+}
+
+// offset of the first element in [begin, begin + length) that is not less than key
+int blockMergeSearchLeft(std::vector<int> &array, int begin, int length, int key) {
+
+    int left = 0;
+    int right = length;
+    while (left < right) {
+        int middle = left + (right - left) / 2;
+        if (lessThan(array[begin + middle], key)) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+
+    return left;
+}
+
+// offset of the first element in [begin, begin + length) that is greater than key
+int blockMergeSearchRight(std::vector<int> &array, int begin, int length, int key) {
+
+    int left = 0;
+    int right = length;
+    while (left < right) {
+        int middle = left + (right - left) / 2;
+        if (lessThan(key, array[begin + middle])) {
+            right = middle;
+        } else {
+            left = middle + 1;
+        }
+    }
+
+    return left;
+}
+
+// stable in-place merge of two adjacent runs by binary searches and rotations
+void blockMergeWithoutBuffer(std::vector<int> &array, int begin, int length1, int length2, sf::Time delay) {
+
+    if (length1 < length2) {
+        while (length1 > 0) {
+
+            // rotate the elements of the second run that belong before the first run's head in front of it
+            int moved = blockMergeSearchLeft(array, begin + length1, length2, array[begin]);
+            if (moved != 0) {
+                blockMergeRotate(array, begin, length1, moved, delay);
+                begin += moved;
+                length2 -= moved;
+            }
+
+            if (length2 == 0) {
+                break;
+            }
+
+            do {
+                begin++;
+                length1--;
+            } while (length1 > 0 && !lessThan(array[begin + length1], array[begin]));
+        }
+    } else {
+        while (length2 > 0) {
+
+            // rotate the elements of the first run that belong after the second run's tail behind it
+            int kept = blockMergeSearchRight(array, begin, length1, array[begin + length1 + length2 - 1]);
+            if (kept != length1) {
+                blockMergeRotate(array, begin + kept, length1 - kept, length2, delay);
+                length1 = kept;
+            }
+
+            if (length1 == 0) {
+                break;
+            }
+
+            do {
+                length2--;
+            } while (length2 > 0 && !lessThan(array[begin + length1 + length2 - 1], array[begin + length1 - 1]));
+        }
+    }
+}
+
+// fallback without an internal buffer for arrays with too few distinct values
+void blockMergeLazySort(std::vector<int> &array, int begin, int length, sf::Time delay) {
+
+    for (int i = begin + 1; i < begin + length; i += 2) {
+        if (lessThan(array[i], array[i - 1])) {
+            blockMergeSwap(array, i - 1, i, delay);
+        }
+    }
+
+    for (int width = 2; width < length; width *= 2) {
+
+        int left = 0;
+        while (left + 2 * width <= length) {
+            blockMergeWithoutBuffer(array, begin + left, width, width, delay);
+            left += 2 * width;
+        }
+
+        if (length - left > width) {
+            blockMergeWithoutBuffer(array, begin + left, width, length - left - width, delay);
+        }
+    }
+}
+
+// collects up to keyCount distinct values (their first occurrences, sorted) at the front of the array
+int blockMergeFindKeys(std::vector<int> &array, int length, int keyCount, sf::Time delay) {
+
+    int keysBegin = 0;
+    int keysFound = 1;
+
+    for (int i = 1; i < length && keysFound < keyCount; i++) {
+
+        int position = blockMergeSearchLeft(array, keysBegin, keysFound, array[i]);
+
+        if (position == keysFound || lessThan(array[i], array[keysBegin + position])) {
+
+            // roll the keys up to the new one and insert it
+            blockMergeRotate(array, keysBegin, keysFound, i - (keysBegin + keysFound), delay);
+            keysBegin = i - keysFound;
+
+            blockMergeRotate(array, keysBegin + position, keysFound - position, 1, delay);
+            keysFound++;
+        }
+    }
+
+    blockMergeRotate(array, 0, keysBegin, keysFound, delay);
+
+    return keysFound;
+}
+
+// merges two adjacent runs into the buffer directly in front of them; the buffer ends up behind the result
+void blockMergeBufferLeft(std::vector<int> &array, int begin, int length1, int length2, int bufferOffset,
+                          sf::Time delay) {
+
+    int dest = begin + bufferOffset;
+    int left = begin;
+    int leftEnd = begin + length1;
+    int right = leftEnd;
+    int rightEnd = right + length2;
+
+    while (right < rightEnd) {
+        if (left == leftEnd || lessThan(array[right], array[left])) {
+            blockMergeSwap(array, dest++, right++, delay);
+        } else {
+            blockMergeSwap(array, dest++, left++, delay);
+        }
+    }
+
+    if (dest != left) {
+        blockMergeSwapRanges(array, dest, left, leftEnd - left, delay);
+    }
+}
+
+// merges two adjacent runs from the back into the buffer directly behind them; the buffer ends up in front
+void blockMergeBufferRight(std::vector<int> &array, int begin, int length1, int length2, int bufferLength,
+                           sf::Time delay) {
+
+    int dest = begin + length1 + length2 + bufferLength - 1;
+    int left = begin + length1 - 1;
+    int right = begin + length1 + length2 - 1;
+
+    while (left >= begin) {
+        if (right < begin + length1 || lessThan(array[right], array[left])) {
+            blockMergeSwap(array, dest--, left--, delay);
+        } else {
+            blockMergeSwap(array, dest--, right--, delay);
+        }
+    }
+
+    while (right != dest && right >= begin + length1) {
+        blockMergeSwap(array, dest--, right--, delay);
+    }
+}
+
+// merges the pending rest of one origin with the next block of the other origin through the buffer.
+// Whatever remains unmerged becomes the new pending rest, with its length and origin written back.
+void blockMergeSmart(std::vector<int> &array, int begin, int &restLength, int &restOrigin, int blockLength,
+                     sf::Time delay) {
+
+    int dest = begin - blockLength;
+    int left = begin;
+    int leftEnd = begin + restLength;
+    int right = leftEnd;
+    int rightEnd = right + blockLength;
+
+    // ties go to the first run (origin 0)
+    while (left < leftEnd && right < rightEnd) {
+        bool takeLeft = restOrigin == 0 ? !lessThan(array[right], array[left]) : lessThan(array[left], array[right]);
+        if (takeLeft) {
+            blockMergeSwap(array, dest++, left++, delay);
+        } else {
+            blockMergeSwap(array, dest++, right++, delay);
+        }
+    }
+
+    if (left < leftEnd) {
+        restLength = leftEnd - left;
+        while (left < leftEnd) {
+            blockMergeSwap(array, --leftEnd, --rightEnd, delay);
+        }
+    } else {
+        restLength = rightEnd - right;
+        restOrigin = 1 - restOrigin;
+    }
+}
+
+// local merges over the sorted blocks of one group, the tags tell which run each block came from
+void blockMergeBlocks(std::vector<int> &array, int keysBegin, int midKey, int begin, int blockCount,
+                      int blockLength, int lastBlockCount, int lastLength, sf::Time delay) {
+
+    if (blockCount == 0) {
+        blockMergeBufferLeft(array, begin, lastBlockCount * blockLength, lastLength, -blockLength, delay);
+        return;
+    }
+
+    int restLength = blockLength;
+    int restOrigin = lessThan(array[keysBegin], midKey) ? 0 : 1;
+    int processedEnd = begin + blockLength;
+
+    for (int block = 1; block < blockCount; block++, processedEnd += blockLength) {
+
+        int restBegin = processedEnd - restLength;
+        int nextOrigin = lessThan(array[keysBegin + block], midKey) ? 0 : 1;
+
+        if (nextOrigin == restOrigin) {
+            // the rest is final, move it in front of the buffer
+            blockMergeSwapRanges(array, restBegin - blockLength, restBegin, restLength, delay);
+            restLength = blockLength;
+        } else {
+            blockMergeSmart(array, restBegin, restLength, restOrigin, blockLength, delay);
+        }
+    }
+
+    int restBegin = processedEnd - restLength;
+
+    if (lastLength > 0) {
+        if (restOrigin == 1) {
+            blockMergeSwapRanges(array, restBegin - blockLength, restBegin, restLength, delay);
+            restBegin = processedEnd;
+            restLength = blockLength * lastBlockCount;
+        } else {
+            restLength += blockLength * lastBlockCount;
+        }
+
+        blockMergeBufferLeft(array, restBegin, restLength, lastLength, -blockLength, delay);
+    } else {
+        blockMergeSwapRanges(array, restBegin, restBegin - blockLength, restLength, delay);
+    }
+}
+
+// builds sorted runs of 2 * bufferLength with buffered merges. The buffer sits in front of the data before and after.
+void blockMergeBuildRuns(std::vector<int> &array, int begin, int length, int bufferLength, sf::Time delay) {
+
+    // sort pairs while moving them two places to the left
+    for (int i = 1; i < length; i += 2) {
+        int swapped = lessThan(array[begin + i], array[begin + i - 1]) ? 1 : 0;
+        blockMergeSwap(array, begin + i - 3, begin + i - 1 + swapped, delay);
+        blockMergeSwap(array, begin + i - 2, begin + i - swapped, delay);
+    }
+    if (length % 2 == 1) {
+        blockMergeSwap(array, begin + length - 1, begin + length - 3, delay);
+    }
+    begin -= 2;
+
+    // each pass merges into the buffer in front, moving the data left by the run width
+    for (int width = 2; width < bufferLength; width *= 2) {
+
+        int left = 0;
+        while (left + 2 * width <= length) {
+            blockMergeBufferLeft(array, begin + left, width, width, -width, delay);
+            left += 2 * width;
+        }
+
+        int rest = length - left;
+        if (rest > width) {
+            blockMergeBufferLeft(array, begin + left, width, rest - width, -width, delay);
+        } else {
+            blockMergeRotate(array, begin + left - width, width, rest, delay);
+        }
+
+        begin -= width;
+    }
+
+    // the buffer is behind the data now, the last pass merges from the back to move it in front again
+    int rest = length % (2 * bufferLength);
+    int left = length - rest;
+
+    if (rest <= bufferLength) {
+        blockMergeRotate(array, begin + left, rest, bufferLength, delay);
+    } else {
+        blockMergeBufferRight(array, begin + left, bufferLength, rest - bufferLength, bufferLength, delay);
+    }
+
+    while (left > 0) {
+        left -= 2 * bufferLength;
+        blockMergeBufferRight(array, begin + left, bufferLength, bufferLength, bufferLength, delay);
+    }
+}
+
+// merges runs of runLength pairwise: blocks of each pair are tagged with keys, selection sorted by their first
+// elements and then merged locally through the buffer
+void blockMergeCombine(std::vector<int> &array, int keysBegin, int begin, int length, int runLength,
+                       int blockLength, sf::Time delay) {
+
+    int groupCount = length / (2 * runLength);
+    int restLength = length % (2 * runLength);
+
+    // a rest without a second run is already sorted
+    if (restLength <= runLength) {
+        length -= restLength;
+        restLength = 0;
+    }
+
+    for (int group = 0; group <= groupCount; group++) {
+
+        bool lastGroup = group == groupCount;
+        if (lastGroup && restLength == 0) {
+            break;
+        }
+
+        int groupBegin = begin + group * 2 * runLength;
+        int blockCount = (lastGroup ? restLength : 2 * runLength) / blockLength;
+
+        // keys below midKey tag blocks of the first run
+        blockMergeInsertionSort(array, keysBegin, blockCount + (lastGroup ? 1 : 0), delay);
+        int midKey = array[keysBegin + runLength / blockLength];
+
+        for (int i = 0; i + 1 < blockCount; i++) {
+
+            int minBlock = i;
+            for (int j = i + 1; j < blockCount; j++) {
+                int first = array[groupBegin + j * blockLength];
+                int minFirst = array[groupBegin + minBlock * blockLength];
+
+                if (lessThan(first, minFirst) ||
+                    (!lessThan(minFirst, first) && lessThan(array[keysBegin + j], array[keysBegin + minBlock]))) {
+                    minBlock = j;
+                }
+            }
+
+            if (minBlock != i) {
+                blockMergeSwapRanges(array, groupBegin + i * blockLength, groupBegin + minBlock * blockLength,
+                                     blockLength, delay);
+                blockMergeSwap(array, keysBegin + i, keysBegin + minBlock, delay);
+            }
+        }
+
+        // first-run blocks that sort after the irregular tail are merged with it at the end
+        int lastBlockCount = 0;
+        int lastLength = lastGroup ? restLength % blockLength : 0;
+
+        if (lastLength != 0) {
+            while (lastBlockCount < blockCount &&
+                   lessThan(array[groupBegin + blockCount * blockLength],
+                            array[groupBegin + (blockCount - lastBlockCount - 1) * blockLength])) {
+                lastBlockCount++;
+            }
+        }
+
+        blockMergeBlocks(array, keysBegin, midKey, groupBegin, blockCount - lastBlockCount, blockLength,
+                         lastBlockCount, lastLength, delay);
+    }
+
+    // move the buffer from behind the merged data back in front of it
+    for (int i = length - 1; i >= 0; i--) {
+        blockMergeSwap(array, begin + i, begin + i - blockLength, delay);
+    }
+}
+
+// stable in-place block merge sort in the style of GrailSort: an internal buffer of distinct values is taken
+// from the array and every move is a swap, so the extra memory is constant
+void blockMergeSort(std::vector<int> &array, sf::Time delay = sf::microseconds(100)) {
+
+    int size = array.size();
+
+    if (size < 16) {
+        blockMergeInsertionSort(array, 0, size, delay);
+        return;
+    }
+
+    int blockLength = 1;
+    while (blockLength * blockLength < size) {
+        blockLength *= 2;
+    }
+
+    int keyCount = (size - 1) / blockLength + 1;
+
+    int keysFound = blockMergeFindKeys(array, size, keyCount + blockLength, delay);
+    if (keysFound < keyCount + blockLength) {
+        blockMergeLazySort(array, 0, size, delay);
+        return;
+    }
+
+    colorRange(0, size, sf::Color::White);
+    colorRange(0, keyCount, blockMergeKeyColor);
+    colorRange(keyCount, keyCount + blockLength, blockMergeBufferColor);
+
+    int dataBegin = keyCount + blockLength;
+    int dataLength = size - dataBegin;
+
+    blockMergeBuildRuns(array, dataBegin, dataLength, blockLength, delay);
+
+    for (int runLength = 2 * blockLength; runLength < dataLength; runLength *= 2) {
+        blockMergeCombine(array, 0, dataBegin, dataLength, runLength, blockLength, delay);
+    }
+
+    // keys and buffer are distinct values, sort them and merge them back in
+    blockMergeInsertionSort(array, 0, dataBegin, delay);
+    blockMergeWithoutBuffer(array, 0, dataBegin, dataLength, delay);
+
+    elementColors.clear();
+}
+
+bool cpuSupportsAvx2() {
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SIMD_X86)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool cpuSupportsSse41() {
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#elif defined(SIMD_X86)
+    return __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+// One compare-exchange layer of a bitonic network over data[0, length): every i is paired with i ^ pairMask and the
+// smaller value goes to the lower index. Partners past the end count as infinitely large, so they are skipped.
+void bitonicLayerScalar(int *data, int length, int pairMask) {
+
+    for (int i = 0; i < length; i++) {
+        int partner = i ^ pairMask;
+
+        if (partner > i && partner < length && lessThan(data[partner], data[i])) {
+            std::swap(data[i], data[partner]);
+            writeCount += 2;
+        }
+    }
+}
+
+#if defined(SIMD_X86)
+
+// 8 lanes at a time. Masks below 8 pair lanes inside one vector. Larger masks are either a power of two
+// (half cleaner, partner vector in the same order) or 2^k - 1 (flip, partner vector reversed).
+TARGET_AVX2 void bitonicLayerAvx2(int *data, int length, int pairMask) {
+
+    int highBit = 1;
+    while (highBit * 2 <= pairMask) {
+        highBit *= 2;
+    }
+
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    unsigned long long pairs = 0;
+
+    for (int block = 0; block < length; block += 8) {
+
+        if (pairMask < 8) {
+            if (block + 8 > length) {
+                bitonicLayerScalar(data + block, length - block, pairMask);
+                continue;
+            }
+
+            __m256i values = _mm256_loadu_si256((__m256i *) (data + block));
+            __m256i partners = _mm256_permutevar8x32_epi32(values, _mm256_xor_si256(lanes, _mm256_set1_epi32(pairMask)));
+            __m256i upper = _mm256_cmpgt_epi32(_mm256_and_si256(lanes, _mm256_set1_epi32(highBit)), _mm256_setzero_si256());
+
+            __m256i result = _mm256_blendv_epi8(_mm256_min_epi32(values, partners),
+                                                _mm256_max_epi32(values, partners), upper);
+            _mm256_storeu_si256((__m256i *) (data + block), result);
+
+            pairs += 4;
+            continue;
+        }
+
+        // only the lower member of each pair of vectors does the work
+        if (block & highBit) {
+            continue;
+        }
+
+        bool reversed = (pairMask & 7) == 7;
+        int partnerBlock = reversed ? (block ^ pairMask) - 7 : block ^ pairMask;
+
+        if (partnerBlock + 8 > length) {
+            // partners partly or fully past the end
+            for (int i = block; i < block + 8 && i < length; i++) {
+                int partner = i ^ pairMask;
+                if (partner < length && lessThan(data[partner], data[i])) {
+                    std::swap(data[i], data[partner]);
+                    writeCount += 2;
+                }
+            }
+            continue;
+        }
+
+        __m256i values = _mm256_loadu_si256((__m256i *) (data + block));
+        __m256i partners = _mm256_loadu_si256((__m256i *) (data + partnerBlock));
+        if (reversed) {
+            partners = _mm256_permutevar8x32_epi32(partners, reverse);
+        }
+
+        __m256i low = _mm256_min_epi32(values, partners);
+        __m256i high = _mm256_max_epi32(values, partners);
+        if (reversed) {
+            high = _mm256_permutevar8x32_epi32(high, reverse);
+        }
+
+        _mm256_storeu_si256((__m256i *) (data + block), low);
+        _mm256_storeu_si256((__m256i *) (data + partnerBlock), high);
+
+        pairs += 8;
+    }
+
+    comparisonCount += pairs;
+    writeCount += 2 * pairs;
+}
+
+// same as the AVX2 layer with 4 lanes
+TARGET_SSE41 void bitonicLayerSse41(int *data, int length, int pairMask) {
+
+    int highBit = 1;
+    while (highBit * 2 <= pairMask) {
+        highBit *= 2;
+    }
+
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    unsigned long long pairs = 0;
+
+    for (int block = 0; block < length; block += 4) {
+
+        if (pairMask < 4) {
+            if (block + 4 > length) {
+                bitonicLayerScalar(data + block, length - block, pairMask);
+                continue;
+            }
+
+            __m128i values = _mm_loadu_si128((__m128i *) (data + block));
+            __m128i partners;
+            switch (pairMask) {
+                case 1:
+                    partners = _mm_shuffle_epi32(values, _MM_SHUFFLE(2, 3, 0, 1));
+                    break;
+                case 2:
+                    partners = _mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2));
+                    break;
+                default:
+                    partners = _mm_shuffle_epi32(values, _MM_SHUFFLE(0, 1, 2, 3));
+                    break;
+            }
+            __m128i upper = _mm_cmpgt_epi32(_mm_and_si128(lanes, _mm_set1_epi32(highBit)), _mm_setzero_si128());
+
+            __m128i result = _mm_blendv_epi8(_mm_min_epi32(values, partners), _mm_max_epi32(values, partners), upper);
+            _mm_storeu_si128((__m128i *) (data + block), result);
+
+            pairs += 2;
+            continue;
+        }
+
+        if (block & highBit) {
+            continue;
+        }
+
+        bool reversed = (pairMask & 3) == 3;
+        int partnerBlock = reversed ? (block ^ pairMask) - 3 : block ^ pairMask;
+
+        if (partnerBlock + 4 > length) {
+            for (int i = block; i < block + 4 && i < length; i++) {
+                int partner = i ^ pairMask;
+                if (partner < length && lessThan(data[partner], data[i])) {
+                    std::swap(data[i], data[partner]);
+                    writeCount += 2;
+                }
+            }
+            continue;
+        }
+
+        __m128i values = _mm_loadu_si128((__m128i *) (data + block));
+        __m128i partners = _mm_loadu_si128((__m128i *) (data + partnerBlock));
+        if (reversed) {
+            partners = _mm_shuffle_epi32(partners, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+
+        __m128i low = _mm_min_epi32(values, partners);
+        __m128i high = _mm_max_epi32(values, partners);
+        if (reversed) {
+            high = _mm_shuffle_epi32(high, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+
+        _mm_storeu_si128((__m128i *) (data + block), low);
+        _mm_storeu_si128((__m128i *) (data + partnerBlock), high);
+
+        pairs += 4;
+    }
+
+    comparisonCount += pairs;
+    writeCount += 2 * pairs;
+}
+
+#endif
+
+using BitonicLayer = void (*)(int *data, int length, int pairMask);
+
+BitonicLayer selectBitonicLayer() {
+#if defined(SIMD_X86)
+    if (cpuSupportsAvx2()) {
+        return bitonicLayerAvx2;
+    }
+    if (cpuSupportsSse41()) {
+        return bitonicLayerSse41;
+    }
+#endif
+    return bitonicLayerScalar;
+}
+
+// picked once at startup from the instruction sets the CPU supports
+const BitonicLayer bitonicLayer = selectBitonicLayer();
+
+// runs one layer of a sorting network over [begin, end) and highlights every element it moved as one batch
+void visualizeLayer(std::vector<int> &array, int begin, int end, sf::Time delay, const std::function<void()> &layer) {
+
+    if (headless) {
+        layer();
+        return;
+    }
+
+    std::vector<int> before(array.begin() + begin, array.begin() + end);
+    layer();
+
+    std::vector<int> exchanged;
+    for (int i = begin; i < end; i++) {
+        if (array[i] != before[i - begin]) {
+            exchanged.push_back(i);
+        }
+    }
+    visualizeBatch(array, delay, exchanged);
+}
+
+// Bitonic sort of [begin, end) for any length, with every merge starting in a flip layer so all comparators point
+// the same way. Meant as a fast base case for blocks of about 16 to 256 elements.
+void bitonicSortRange(std::vector<int> &array, int begin, int end, sf::Time delay) {
+
+    int length = end - begin;
+    int *data = array.data() + begin;
+
+    auto runLayer = [&](int pairMask) {
+        visualizeLayer(array, begin, end, delay, [&]() { bitonicLayer(data, length, pairMask); });
+    };
+
+    for (int size = 2; size < 2 * length; size *= 2) {
+
+        runLayer(size - 1);
+
+        for (int distance = size / 4; distance > 0; distance /= 2) {
+            runLayer(distance);
+        }
+    }
+}
+
+void bitonicSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(50)) {
+    bitonicSortRange(array, 0, array.size(), delay);
+}
+
+// Branch-free compare-exchange for the data-oblivious networks below: both positions are always read and
+// written, only the selected values depend on the data.
+void compareExchange(std::vector<int> &array, int indexA, int indexB) {
+    int a = array[indexA];
+    int b = array[indexB];
+    bool exchange = lessThan(b, a);
+    array[indexA] = exchange ? b : a;
+    array[indexB] = exchange ? a : b;
+    writeCount += 2;
+}
+
+// compare-exchanges per parallelFor task, small layers run on the calling thread
+const int networkChunkSize = 8192;
+
+// n phases that alternately compare-exchange the (even, odd) and (odd, even) neighbours
+void oddEvenTranspositionSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(10)) {
+
+    int size = array.size();
+
+    for (int phase = 0; phase < size; phase++) {
+
+        int first = phase % 2;
+        int pairCount = (size - first) / 2;
+        int taskCount = (pairCount + networkChunkSize - 1) / networkChunkSize;
+
+        visualizeLayer(array, 0, size, delay, [&]() {
+            parallelFor(taskCount, [&](int task) {
+                int pairEnd = std::min(pairCount, (task + 1) * networkChunkSize);
+                for (int pair = task * networkChunkSize; pair < pairEnd; pair++) {
+                    compareExchange(array, first + 2 * pair, first + 2 * pair + 1);
+                }
+            });
+        });
+    }
+}
+
+// Batcher's network: merges sorted blocks of size p pairwise with layers at distances p, p/2, ..., 1.
+// Comparators past the end are dropped, which is the same as padding with infinitely large elements.
+void oddEvenMergeSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(50)) {
+
+    int size = array.size();
+
+    for (int p = 1; p < size; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+
+            // every j starts a group of k comparators (i + j, i + j + k) that stay inside one block of size 2p
+            int firstJ = k % p;
+            int groupCount = firstJ + k < size ? (size - firstJ - k - 1) / (2 * k) + 1 : 0;
+            int groupsPerTask = std::max(1, networkChunkSize / k);
+            int taskCount = (groupCount + groupsPerTask - 1) / groupsPerTask;
+
+            visualizeLayer(array, 0, size, delay, [&]() {
+                parallelFor(taskCount, [&](int task) {
+                    int groupEnd = std::min(groupCount, (task + 1) * groupsPerTask);
+                    for (int group = task * groupsPerTask; group < groupEnd; group++) {
+                        int j = firstJ + 2 * k * group;
+                        for (int i = 0; i < std::min(k, size - j - k); i++) {
+                            if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                                compareExchange(array, i + j, i + j + k);
+                            }
+                        }
+                    }
+                });
+            });
+        }
+    }
+}
+
+// Partition predicate of the quick sorts: elements less than the pivot go left, or with orEqual elements not greater
+// than the pivot, which is used to split off a run of elements equal to the pivot.
+template<typename T, typename Less = KeyLess<>>
+bool belongsLeft(const T &value, const T &pivot, bool orEqual, Less less = {}) {
+    return orEqual ? !less(pivot, value) : less(value, pivot);
+}
+
+// Hoare style partition of [begin, end), returns the first index of the right part
+template<typename T, typename Less = KeyLess<>>
+int partitionScalar(std::vector<T> &array, int begin, int end, const T &pivot, bool orEqual, sf::Time delay,
+                    Less less = {}) {
+
+    int left = begin;
+    int right = end - 1;
+
+    while (true) {
+        while (left <= right && belongsLeft(array[left], pivot, orEqual, less)) {
+            left++;
+        }
+        while (left <= right && !belongsLeft(array[right], pivot, orEqual, less)) {
+            right--;
+        }
+
+        if (left >= right) {
+            return left;
+        }
+
+        swapElements(array, left, right, less);
+        visualizeWith(less, array, delay, left, right);
+
+        left++;
+        right--;
+    }
+}
+
+#if defined(SIMD_X86)
+
+// for every 8 bit mask the lane order that moves the set lanes to the front, keeping the rest behind them
+struct CompressTable {
+    alignas(32) int permutations[256][8];
+
+    CompressTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int next = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane)) {
+                    permutations[mask][next++] = lane;
+                }
+            }
+            for (int lane = 0; lane < 8; lane++) {
+                if (!(mask & (1 << lane))) {
+                    permutations[mask][next++] = lane;
+                }
+            }
+        }
+    }
+};
+
+const CompressTable compressTable;
+
+// In-place partition 8 elements at a time. Each vector is compared against the pivot and permuted so that its left
+// lanes come first, then stored in full at both write ends; only the lanes that belong there are kept by advancing
+// the write positions. One vector from each end is held back so there are always 8 free slots on both sides.
+TARGET_AVX2 int partitionAvx2(std::vector<int> &array, int begin, int end, int pivot, bool orEqual, sf::Time delay) {
+
+    if (end - begin < 24) {
+        return partitionScalar(array, begin, end, pivot, orEqual, delay);
+    }
+
+    int *data = array.data();
+    const __m256i pivotVector = _mm256_set1_epi32(pivot);
+
+    __m256i heldLeft = _mm256_loadu_si256((__m256i *) (data + begin));
+    __m256i heldRight = _mm256_loadu_si256((__m256i *) (data + end - 8));
+
+    int readLeft = begin + 8;
+    int readRight = end - 8;
+    int writeLeft = begin;
+    int writeRight = end;
+
+    std::vector<int> written;
+
+    while (readRight - readLeft >= 8) {
+
+        // read from the side with less free space so neither write end can overtake its read end
+        __m256i values;
+        if (readLeft - writeLeft <= writeRight - readRight) {
+            values = _mm256_loadu_si256((__m256i *) (data + readLeft));
+            readLeft += 8;
+        } else {
+            readRight -= 8;
+            values = _mm256_loadu_si256((__m256i *) (data + readRight));
+        }
+
+        int mask;
+        if (orEqual) {
+            mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(values, pivotVector))) & 0xFF;
+        } else {
+            mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivotVector, values)));
+        }
+        int leftCount = _mm_popcnt_u32(mask);
+
+        __m256i permutation = _mm256_load_si256((__m256i *) compressTable.permutations[mask]);
+        __m256i compressed = _mm256_permutevar8x32_epi32(values, permutation);
+
+        _mm256_storeu_si256((__m256i *) (data + writeLeft), compressed);
+        _mm256_storeu_si256((__m256i *) (data + writeRight - 8), compressed);
+
+        comparisonCount += 8;
+        writeCount += 8;
+
+        if (!headless) {
+            written.clear();
+            for (int i = 0; i < leftCount; i++) {
+                written.push_back(writeLeft + i);
+            }
+            for (int i = leftCount; i < 8; i++) {
+                written.push_back(writeRight - 8 + i);
+            }
+            visualizeBatch(array, delay, written);
+        }
+
+        writeLeft += leftCount;
+        writeRight -= 8 - leftCount;
+    }
+
+    // the unread rest and the two held back vectors exactly fill the gap between the write ends
+    int rest[24];
+    int restCount = readRight - readLeft;
+    std::copy(data + readLeft, data + readRight, rest);
+    _mm256_storeu_si256((__m256i *) (rest + restCount), heldLeft);
+    _mm256_storeu_si256((__m256i *) (rest + restCount + 8), heldRight);
+    restCount += 16;
+
+    for (int i = 0; i < restCount; i++) {
+        if (belongsLeft(rest[i], pivot, orEqual)) {
+            data[writeLeft++] = rest[i];
+            visualize(array, delay, writeLeft - 1);
+        } else {
+            data[--writeRight] = rest[i];
+            visualize(array, delay, writeRight);
+        }
+        writeCount++;
+    }
+
+    return writeLeft;
+}
+
+#endif
+
+using PartitionFunction = int (*)(std::vector<int> &array, int begin, int end, int pivot, bool orEqual, sf::Time delay);
+
+PartitionFunction selectVectorPartition() {
+#if defined(SIMD_X86)
+    if (cpuSupportsAvx2()) {
+        return partitionAvx2;
+    }
+#endif
+    return [](std::vector<int> &array, int begin, int end, int pivot, bool orEqual, sf::Time delay) {
+        return partitionScalar(array, begin, end, pivot, orEqual, delay);
+    };
+}
+
+// AVX2 partition where the CPU supports it, scalar otherwise
+const PartitionFunction vectorPartition = selectVectorPartition();
+
+template<typename T, typename Less>
+T medianOfThree(T a, T b, T c, Less less) {
+
+    if (less(b, a)) {
+        std::swap(a, b);
+    }
+    if (less(c, b)) {
+        b = less(c, a) ? a : c;
+    }
+
+    return b;
+}
+
+// the partition step and the base case for small ranges a quick sort variant is built from
+template<typename T, typename Less>
+struct QuickSortKernels {
+    int (*partition)(std::vector<T> &array, int begin, int end, const T &pivot, bool orEqual, sf::Time delay,
+                     Less less);
+    void (*smallSort)(std::vector<T> &array, int begin, int end, sf::Time delay, Less less);
+    int smallSize; // ranges up to this size go to smallSort
+};
+
+// Introsort loop: recurses into the smaller part and loops on the larger one, falls back to heap sort when the
+// depth limit runs out and hands small ranges to the base case. A range whose left neighbour equals the pivot
+// (or whose pivot is its minimum) only splits off the elements equal to the pivot, so few unique values stay fast.
+template<typename T, typename Less>
+void quickSortRange(std::vector<T> &array, int begin, int end, int depthLimit, bool leftmost,
+                    const QuickSortKernels<T, Less> &kernels, sf::Time delay, Less less) {
+
+    while (end - begin > kernels.smallSize) {
+
+        if (depthLimit == 0) {
+            dAryHeapSort<2>(array, begin, end, delay, less);
+            return;
+        }
+        depthLimit--;
+
+        int size = end - begin;
+        int middle = begin + size / 2;
+
+        T pivot;
+        if (size > 128) {
+            // ninther
+            int step = size / 8;
+            pivot = medianOfThree(medianOfThree(array[begin], array[begin + step], array[begin + 2 * step], less),
+                                  medianOfThree(array[middle - step], array[middle], array[middle + step], less),
+                                  medianOfThree(array[end - 1 - 2 * step], array[end - 1 - step], array[end - 1], less),
+                                  less);
+        } else {
+            pivot = medianOfThree(array[begin], array[middle], array[end - 1], less);
+        }
+
+        visualizeWith(less, array, delay, begin, end - 1);
+
+        if (!leftmost && !less(array[begin - 1], pivot)) {
+            begin = kernels.partition(array, begin, end, pivot, true, delay, less);
+            continue;
+        }
+
+        int split = kernels.partition(array, begin, end, pivot, false, delay, less);
+        if (split == begin) {
+            begin = kernels.partition(array, begin, end, pivot, true, delay, less);
+            continue;
+        }
+
+        if (split - begin < end - split) {
+            quickSortRange(array, begin, split, depthLimit, leftmost, kernels, delay, less);
+            begin = split;
+            leftmost = false;
+        } else {
+            quickSortRange(array, split, end, depthLimit, false, kernels, delay, less);
+            end = split;
+        }
+    }
+
+    kernels.smallSort(array, begin, end, delay, less);
+}
+
+template<typename T, typename Less>
+void quickSort(std::vector<T> &array, const QuickSortKernels<T, Less> &kernels, sf::Time delay, Less less) {
+
+    int depthLimit = 0;
+    for (int size = array.size(); size > 1; size /= 2) {
+        depthLimit += 2;
+    }
+
+    quickSortRange(array, 0, array.size(), depthLimit, true, kernels, delay, less);
+}
+
+// scalar partition with binary insertion sort for small ranges, fewest comparisons and writes
+template<typename T, typename Less = KeyLess<>>
+void quickSort(std::vector<T> &array, sf::Time delay = sf::milliseconds(2), Less less = {}) {
+    QuickSortKernels<T, Less> kernels{partitionScalar<T, Less>, binaryInsertionSortRange<T, Less>, 24};
+    quickSort(array, kernels, delay, less);
+}
+
+// vector partition with the bitonic network for small ranges, fastest where AVX2 is available
+void vectorQuickSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(2)) {
+    QuickSortKernels<int, KeyLess<>> kernels{
+            [](std::vector<int> &array, int begin, int end, const int &pivot, bool orEqual, sf::Time delay, KeyLess<>) {
+                return vectorPartition(array, begin, end, pivot, orEqual, delay);
+            },
+            [](std::vector<int> &array, int begin, int end, sf::Time delay, KeyLess<>) {
+                bitonicSortRange(array, begin, end, delay);
+            },
+            64};
+    quickSort(array, kernels, delay, KeyLess<>{});
+}
+
+// sample sort: splitters from a sorted oversample classify the elements into buckets in parallel, the buckets are
+// scattered in parallel and then sorted independently, so there is no serial merge at the end
+void sampleSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+
+    const int chunkSize = 1 << 16;
+
+    int size = array.size();
+
+    // a power of two number of buckets, a few per thread, with at least 32 elements per bucket on average
+    int bucketCount = 2;
+    int levels = 1;
+    while (bucketCount < 256 && bucketCount < 4 * threadCount && bucketCount * 64 <= size) {
+        bucketCount *= 2;
+        levels++;
+    }
+
+    // larger buckets get more samples per splitter to keep their sizes even
+    int oversampling = std::clamp(size / (bucketCount * 64), 4, 256);
+
+    sf::Clock clock;
+
+    // sample the splitters
+    Xoshiro256 generator = randomStream(RandomStream::Splitters);
+
+    std::vector<int> sample(bucketCount * oversampling);
+    for (int &element: sample) {
+        int index = randomBelow(generator, size);
+        element = array[index];
+        visualize(array, delay, index);
+    }
+    std::sort(sample.begin(), sample.end(), lessThan);
+
+    // splitters in an implicit search tree (node i has children 2i and 2i + 1) so classification is a branchless
+    // descent. An in-order walk over the tree visits the splitters in sorted order.
+    std::vector<int> splitterTree(bucketCount);
+    int nextSplitter = 1;
+    std::function<void(int)> fillTree = [&](int node) {
+        if (node < bucketCount) {
+            fillTree(2 * node);
+            splitterTree[node] = sample[nextSplitter++ * oversampling - 1];
+            fillTree(2 * node + 1);
+        }
+    };
+    fillTree(1);
+
+    sf::Time samplingTime = clock.restart();
+
+    // classify the elements chunk by chunk, remembering each element's bucket and counting the bucket sizes per chunk
+    int chunkCount = (size + chunkSize - 1) / chunkSize;
+    std::vector<unsigned char> bucketIndices(size);
+    std::vector<int> bucketSizes(chunkCount * bucketCount);
+
+    parallelFor(chunkCount, [&](int chunk) {
+        int begin = chunk * chunkSize;
+        int end = std::min(begin + chunkSize, size);
+        int *chunkBucketSizes = &bucketSizes[chunk * bucketCount];
+
+        for (int i = begin; i < end; i++) {
+            int node = 1;
+            for (int level = 0; level < levels; level++) {
+                node = 2 * node + (splitterTree[node] < array[i]);
+            }
+            int bucket = node - bucketCount;
+
+            bucketIndices[i] = bucket;
+            chunkBucketSizes[bucket]++;
+
+            colorRange(i, i + 1, segmentColors[bucket % IM_ARRAYSIZE(segmentColors)]);
+            visualize(array, delay, i);
+        }
+
+        comparisonCount += (unsigned long long) (end - begin) * levels;
+    });
+
+    sf::Time classificationTime = clock.restart();
+
+    // exclusive prefix sums over buckets, then chunks, give every chunk its write position in every bucket
+    std::vector<int> bucketBegins(bucketCount + 1);
+    std::vector<int> chunkOffsets(chunkCount * bucketCount);
+
+    int offset = 0;
+    for (int bucket = 0; bucket < bucketCount; bucket++) {
+        bucketBegins[bucket] = offset;
+        for (int chunk = 0; chunk < chunkCount; chunk++) {
+            chunkOffsets[chunk * bucketCount + bucket] = offset;
+            offset += bucketSizes[chunk * bucketCount + bucket];
+        }
+    }
+    bucketBegins[bucketCount] = size;
+
+    std::vector<int> temp(size);
+
+    parallelFor(chunkCount, [&](int chunk) {
+        int begin = chunk * chunkSize;
+        int end = std::min(begin + chunkSize, size);
+        int *offsets = &chunkOffsets[chunk * bucketCount];
+
+        for (int i = begin; i < end; i++) {
+            temp[offsets[bucketIndices[i]]++] = array[i];
+        }
+
+        writeCount += end - begin;
+    });
+
+    sf::Time scatterTime = clock.restart();
+
+    // copy each bucket back and sort it on its own
+    elementColors.clear();
+
+    parallelFor(bucketCount, [&](int bucket) {
+        int begin = bucketBegins[bucket];
+        int end = bucketBegins[bucket + 1];
+
+        for (int i = begin; i < end; i++) {
+            array[i] = temp[i];
+            writeCount++;
+            colorRange(i, i + 1, segmentColors[bucket % IM_ARRAYSIZE(segmentColors)]);
+            visualize(array, delay, i);
+        }
+
+        if (end - begin <= 256) {
+            bitonicSortRange(array, begin, end, delay);
+        } else {
+            std::sort(array.begin() + begin, array.begin() + end, lessThan);
+            visualize(array, delay, begin, end - 1);
+        }
+    });
+
+    sf::Time bucketSortTime = clock.restart();
+
+    elementColors.clear();
+
+    int largestBucket = 0;
+    int smallestBucket = size;
+    for (int bucket = 0; bucket < bucketCount; bucket++) {
+        largestBucket = std::max(largestBucket, bucketBegins[bucket + 1] - bucketBegins[bucket]);
+        smallestBucket = std::min(smallestBucket, bucketBegins[bucket + 1] - bucketBegins[bucket]);
+    }
+    double averageBucket = (double) size / bucketCount;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "  phases (ms): sampling %.3f, classification %.3f, scatter %.3f, bucket sort %.3f",
+                  samplingTime.asMicroseconds() / 1000.0, classificationTime.asMicroseconds() / 1000.0,
+                  scatterTime.asMicroseconds() / 1000.0, bucketSortTime.asMicroseconds() / 1000.0);
+    sortReport.emplace_back(line);
+    std::snprintf(line, sizeof(line), "  %d buckets on %d threads: largest %.2fx, smallest %.2fx the average of %.0f",
+                  bucketCount, headless ? threadCount : 1, largestBucket / averageBucket,
+                  smallestBucket / averageBucket, averageBucket);
+    sortReport.emplace_back(line);
+}
+
+// counts of every value in [minElement, minElement + range), built in 4 interleaved sub-histograms so
+// runs of equal keys increment different counters instead of stalling on the same store
+std::vector<int> denseHistogram(std::vector<int> &array, int minElement, int range) {
+
+    const int lanes = 4;
+    std::vector<int> subCounts(lanes * range);
+    int *lane0 = subCounts.data();
+    int *lane1 = lane0 + range;
+    int *lane2 = lane1 + range;
+    int *lane3 = lane2 + range;
+
+    int i = 0;
+    for (; i + lanes <= array.size(); i += lanes) {
+        lane0[array[i] - minElement]++;
+        lane1[array[i + 1] - minElement]++;
+        lane2[array[i + 2] - minElement]++;
+        lane3[array[i + 3] - minElement]++;
+    }
+    for (; i < array.size(); i++) {
+        lane0[array[i] - minElement]++;
+    }
+
+    std::vector<int> count(range);
+    for (int value = 0; value < range; value++) {
+        count[value] = lane0[value] + lane1[value] + lane2[value] + lane3[value];
+    }
+
+    return count;
+}
+
+// countingSort and pigeonholeSort leave inputs whose range is more than this many times the array size to radixSort
+const int sparseRangeFactor = 16;
+
+void radixSort(std::vector<int> &array, sf::Time delay);
+
+// range of the values in the array, in 64 bits as max - min overflows int for wide inputs
+long long valueRange(const std::vector<int> &array) {
+    auto [minIt, maxIt] = std::minmax_element(array.begin(), array.end());
+    return (long long) *maxIt - *minIt + 1;
+}
+
+// true, with a line in the sort report, if the histogram of a counting pass would be too sparse to be worth it
+bool tooSparse(const std::vector<int> &array, const char *name) {
+
+    long long range = valueRange(array);
+    if (range <= (long long) sparseRangeFactor * array.size()) {
+        return false;
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %s: range %lld is more than %dx the size, sorted by Radix Sort instead",
+                  name, range, sparseRangeFactor);
+    sortReport.emplace_back(line);
+    return true;
+}
+
+// rewrites the array from the histogram of its values, O(n + range)
+void countingSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(1)) {
+
+    if (array.empty()) {
+        return;
+    }
+    if (tooSparse(array, "Counting Sort")) {
+        radixSort(array, delay);
+        return;
+    }
+
+    int minElement = *std::min_element(array.begin(), array.end());
+    int range = valueRange(array);
+
+    std::vector<int> count = denseHistogram(array, minElement, range);
+
+    int index = 0;
+    for (int value = 0; value < range; value++) {
+        for (int c = 0; c < count[value]; c++) {
+            array[index] = value + minElement;
+            writeCount++;
+            visualize(array, delay, index);
+            index++;
+        }
+    }
+}
+
+// moves every element into the hole of its value, stable unlike countingSort which only rewrites keys
+void pigeonholeSort(std::vector<int> &array, sf::Time delay = sf::milliseconds(1)) {
+
+    if (array.empty()) {
+        return;
+    }
+    if (tooSparse(array, "Pigeonhole Sort")) {
+        radixSort(array, delay);
+        return;
+    }
+
+    int minElement = *std::min_element(array.begin(), array.end());
+    int range = valueRange(array);
+
+    // start of every hole in the output
+    std::vector<int> holeStart = denseHistogram(array, minElement, range);
+    int offset = 0;
+    for (int &start: holeStart) {
+        int size = start;
+        start = offset;
+        offset += size;
+    }
+
+    std::vector<int> temp(array.size());
+    for (int i: array) {
+        temp[holeStart[i - minElement]++] = i;
+        writeCount++;
+    }
+
+    writeVisualize(temp, array, delay);
+}
+
+// radixSort switches to countingSort while the histogram is at most this many times the array size
+const int denseRangeFactor = 2;
+
+void radixSort(std::vector<int> &array, sf::Time delay = sf::microseconds(500)) {
+
+    // dense keys like the default permutation of 1..n are sorted in a single counting pass
+    auto [minIt, maxIt] = std::minmax_element(array.begin(), array.end());
+    if ((long long) *maxIt - *minIt < (long long) denseRangeFactor * array.size()) {
+        countingSort(array, delay);
+        return;
+    }
+
+    std::vector<int> temp(array.size());
+
+    // digits of the offset from the minimum, so negative elements sort as well
+    int minElement = *minIt;
+    std::uint32_t range = (std::uint32_t) *maxIt - (std::uint32_t) minElement;
+    auto digit = [&](int element, long long exp) {
+        return ((std::uint32_t) element - (std::uint32_t) minElement) / exp % 10;
+    };
+
+    for (long long exp = 1; range / exp > 0; exp *= 10) {
+
+        std::vector<int> count(10);
+
+        for (int i: array) {
+            count[digit(i, exp)]++;
+        }
+
+        for (int i = 1; i < count.size(); i++) {
+            count[i] += count[i - 1];
+        }
+
+        for (int i = array.size() - 1; i >= 0; i--) {
+            temp[count[digit(array[i], exp)] - 1] = array[i];
+            writeCount++;
+            count[digit(array[i], exp)]--;
+        }
+
+        writeVisualize(temp, array, delay);
+        visualize(array, sf::Time::Zero);
+    }
+}
+
+// Unsigned key with the same order as the value: signed integers get their sign bit flipped, negative floating point
+// numbers have all bits flipped so larger magnitudes come first, positive ones only the sign bit.
+template<typename Key>
+auto radixKey(Key key) {
+    if constexpr (std::is_floating_point_v<Key>) {
+        using Bits = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+        const Bits signBit = Bits(1) << (sizeof(Bits) * 8 - 1);
+        Bits bits = std::bit_cast<Bits>(key);
+        return (bits & signBit) ? Bits(~bits) : Bits(bits | signBit);
+    } else if constexpr (std::is_signed_v<Key>) {
+        using Bits = std::make_unsigned_t<Key>;
+        return Bits(Bits(key) ^ (Bits(1) << (sizeof(Key) * 8 - 1)));
+    } else {
+        return key;
+    }
+}
+
+// LSD radix sort on the bytes of radixKey() of the key projected by less, skipping bytes that are equal in every
+// element. Only the projection and the instrumentation policy of less are used, keys always sort ascending.
+template<typename T, typename Less = KeyLess<>>
+void byteRadixSort(std::vector<T> &array, Less less = {}) {
+
+    const auto &projection = less.projection;
+    using Key = decltype(radixKey(std::invoke(projection, array[0])));
+    int size = array.size();
+    if (size < 2) {
+        return;
+    }
+
+    std::vector<T> temp(size);
+    std::vector<T> *src = &array;
+    std::vector<T> *dst = &temp;
+
+    for (int shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+
+        std::array<int, 256> count{};
+        for (const T &element: *src) {
+            count[(radixKey(std::invoke(projection, element)) >> shift) & 0xFF]++;
+        }
+        if (count[(radixKey(std::invoke(projection, (*src)[0])) >> shift) & 0xFF] == size) {
+            continue;
+        }
+
+        int offset = 0;
+        for (int &bucket: count) {
+            int bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (T &element: *src) {
+            (*dst)[count[(radixKey(std::invoke(projection, element)) >> shift) & 0xFF]++] = std::move(element);
+        }
+        countWritesWith(less, size);
+
+        std::swap(src, dst);
+    }
+
+    if (src != &array) {
+        array = std::move(temp);
+        countWritesWith(less, size);
+    }
+}
+
+// MSD radix sort of the strings in [begin, end) that share their first depth characters, temp is the scatter buffer
+template<typename T, typename Less>
+void stringRadixSortRange(std::vector<T> &array, std::vector<T> &temp, int begin, int end, int depth, Less less) {
+
+    // small buckets compare whole strings instead of paying for 257 counters per character
+    if (end - begin <= 32) {
+        binaryInsertionSortRange(array, begin, end, sf::Time::Zero, less);
+        return;
+    }
+
+    const auto &projection = less.projection;
+
+    // bucket 0 holds the strings that end before depth, bucket c + 1 the ones with character c at depth
+    auto bucketOf = [&](const T &element) {
+        std::string_view string = std::invoke(projection, element);
+        return string.size() <= depth ? 0 : 1 + (unsigned char) string[depth];
+    };
+
+    std::array<int, 258> start{};
+    for (int i = begin; i < end; i++) {
+        start[bucketOf(array[i]) + 1]++;
+    }
+    for (int bucket = 1; bucket < start.size(); bucket++) {
+        start[bucket] += start[bucket - 1];
+    }
+
+    std::array<int, 258> next = start;
+    for (int i = begin; i < end; i++) {
+        temp[begin + next[bucketOf(array[i])]++] = std::move(array[i]);
+    }
+    std::move(temp.begin() + begin, temp.begin() + end, array.begin() + begin);
+    countWritesWith(less, 2 * (end - begin));
+
+    for (int bucket = 1; bucket < 257; bucket++) {
+        if (start[bucket + 1] - start[bucket] > 1) {
+            stringRadixSortRange(array, temp, begin + start[bucket], begin + start[bucket + 1], depth + 1, less);
+        }
+    }
+}
+
+template<typename T, typename Less = KeyLess<>>
+void stringRadixSort(std::vector<T> &array, Less less = {}) {
+    std::vector<T> temp(array.size());
+    stringRadixSortRange(array, temp, 0, array.size(), 0, less);
+}
+
+// Sorted runs in temporary files as run source of a LoserTree. Every run reads through two buffers: while the
+// merge consumes one block, the next one is read into the other buffer asynchronously.
+struct FileRuns {
+    struct Run {
+        std::FILE *file;
+        std::vector<int> buffer;
+        std::vector<int> nextBuffer;
+        size_t length = 0;
+        size_t position = 0;
+        std::future<size_t> pending;
+    };
+
+    std::vector<Run> runs;
+
+    FileRuns(const std::vector<std::FILE *> &files, size_t blockSize) : runs(files.size()) {
+        for (int run = 0; run < runs.size(); run++) {
+            Run &r = runs[run];
+            r.file = files[run];
+            r.buffer.resize(blockSize);
+            r.nextBuffer.resize(blockSize);
+            std::rewind(r.file);
+            r.length = std::fread(r.buffer.data(), sizeof(int), blockSize, r.file);
+            readAhead(r);
+        }
+    }
+
+    static void readAhead(Run &r) {
+        if (r.length == r.buffer.size()) {
+            r.pending = std::async(std::launch::async, [file = r.file, data = r.nextBuffer.data(),
+                    size = r.nextBuffer.size()]() { return std::fread(data, sizeof(int), size, file); });
+        }
+    }
+
+    int count() const { return runs.size(); }
+
+    bool exhausted(int run) const { return runs[run].position == runs[run].length; }
+
+    int head(int run) const { return runs[run].buffer[runs[run].position]; }
+
+    void advance(int run) {
+        Run &r = runs[run];
+        r.position++;
+
+        // switch to the block read in the background and start reading the one after it
+        if (r.position == r.length && r.pending.valid()) {
+            r.length = r.pending.get();
+            r.position = 0;
+            std::swap(r.buffer, r.nextBuffer);
+            readAhead(r);
+        }
+    }
+};
+
+// elements of the file shown by the visualizer during an external sort
+const int externalViewSize = 1024;
+
+// most runs merged in one pass, bounding the open temporary files and the read-ahead threads of a merge
+const int maxMergeFanIn = 128;
+
+// outcome of an external sort
+enum class ExternalSortResult {
+    Sorted,
+    FileError, // the input cannot be read or the output cannot be written
+    TempFileError, // a temporary run file cannot be created or written, e.g. at the limit of open files
+};
+
+// a sorted run spilled to a temporary file
+struct RunFile {
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file;
+    long long length;
+};
+
+// Merges runs through a loser tree into output, with the budget split into two buffers per run and one output
+// buffer of 16 KiB to 4 MiB each. onElement(position, value) sees every merged element. Returns false if a write
+// fails.
+template<typename OnElement>
+bool mergeRunFiles(const std::vector<RunFile> &runFiles, std::FILE *output, long long memoryBytes,
+                   OnElement onElement) {
+
+    std::vector<std::FILE *> files;
+    long long elementCount = 0;
+    for (const RunFile &runFile: runFiles) {
+        files.push_back(runFile.file.get());
+        elementCount += runFile.length;
+    }
+    size_t blockSize = std::clamp(memoryBytes / (long long) sizeof(int) / (2 * (long long) files.size() + 1),
+                                  4096ll, 1ll << 20);
+
+    FileRuns runs(files, blockSize);
+    LoserTree<FileRuns> loserTree(runs);
+
+    std::vector<int> outputBuffer;
+    outputBuffer.reserve(blockSize);
+
+    for (long long position = 0; position < elementCount; position++) {
+        int value = loserTree.pop();
+        outputBuffer.push_back(value);
+
+        if (outputBuffer.size() == blockSize || position + 1 == elementCount) {
+            if (std::fwrite(outputBuffer.data(), sizeof(int), outputBuffer.size(), output) != outputBuffer.size()) {
+                return false;
+            }
+            writeCount += outputBuffer.size();
+            outputBuffer.clear();
+        }
+
+        onElement(position, value);
+    }
+
+    return true;
+}
+
+// merges runFiles[begin, end) into one new temporary run file, nullptr in file if that fails
+RunFile mergeIntoTempFile(std::vector<RunFile> &runFiles, int begin, int end, long long memoryBytes) {
+
+    std::vector<RunFile> group(std::make_move_iterator(runFiles.begin() + begin),
+                               std::make_move_iterator(runFiles.begin() + end));
+    runFiles.erase(runFiles.begin() + begin, runFiles.begin() + end);
+
+    RunFile merged{{std::tmpfile(), std::fclose}, 0};
+    for (const RunFile &runFile: group) {
+        merged.length += runFile.length;
+    }
+    if (merged.file && !mergeRunFiles(group, merged.file.get(), memoryBytes, [](long long, int) {})) {
+        merged.file.reset();
+    }
+    return merged;
+}
+
+// Sorts a binary file of native ints with at most memoryBytes of buffers: sorted runs that fill the budget are
+// spilled to temporary files with one large write each, then merged through a loser tree. Up to maxMergeFanIn
+// runs are merged in one pass; beyond that, every maxMergeFanIn runs of one level are merged into a run of the
+// next level as soon as they exist, so the open files stay bounded. The visualizer shows a downsampled view of the
+// file.
+ExternalSortResult externalSort(const std::string &inputPath, const std::string &outputPath, long long memoryBytes,
+                                sf::Time delay = sf::milliseconds(1)) {
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> input(std::fopen(inputPath.c_str(), "rb"), std::fclose);
+    if (!input) {
+        return ExternalSortResult::FileError;
+    }
+
+    std::fseek(input.get(), 0, SEEK_END);
+    long long elementCount = std::ftell(input.get()) / sizeof(int);
+    std::rewind(input.get());
+
+    if (elementCount == 0) {
+        bool written = std::unique_ptr<std::FILE, int (*)(std::FILE *)>(std::fopen(outputPath.c_str(), "wb"),
+                                                                         std::fclose) != nullptr;
+        return written ? ExternalSortResult::Sorted : ExternalSortResult::FileError;
+    }
+
+    size_t runCapacity = std::min(elementCount, std::max(1024ll, memoryBytes / (long long) sizeof(int)));
+
+    // every view element shows the element at the same relative position in the file,
+    // scaled to [1, 1024] by the value range of the first run
+    std::vector<int> view(std::min(elementCount, (long long) externalViewSize), 1);
+    long long minValue = 0;
+    long long valueRange = 1;
+    auto viewValue = [&](int value) {
+        long long scaled = (value - minValue) * 1023 / valueRange + 1;
+        return (int) std::clamp(scaled, 1ll, 1024ll);
+    };
+    auto viewSlot = [&](long long position) { return (int) (position * view.size() / elementCount); };
+    auto slotPosition = [&](int slot) { return (long long) slot * elementCount / view.size(); };
+
+    sf::Clock clock;
+
+    // run generation, levels[l] holds runs merged from maxMergeFanIn^l initial runs
+    std::vector<std::vector<RunFile>> levels(1);
+    std::vector<int> run(runCapacity);
+    long long runStart = 0;
+    int runCount = 0;
+    int intermediateMerges = 0;
+
+    while (true) {
+        run.resize(runCapacity);
+        size_t length = std::fread(run.data(), sizeof(int), runCapacity, input.get());
+        if (length == 0) {
+            break;
+        }
+        run.resize(length);
+
+        std::sort(run.begin(), run.end(), [](int a, int b) { return lessThan(a, b); });
+
+        RunFile runFile{{std::tmpfile(), std::fclose}, (long long) length};
+        if (!runFile.file || std::fwrite(run.data(), sizeof(int), length, runFile.file.get()) != length) {
+            return ExternalSortResult::TempFileError;
+        }
+        writeCount += length;
+        levels[0].push_back(std::move(runFile));
+        runCount++;
+
+        for (int level = 0; levels[level].size() == maxMergeFanIn; level++) {
+            RunFile merged = mergeIntoTempFile(levels[level], 0, maxMergeFanIn, memoryBytes);
+            if (!merged.file) {
+                return ExternalSortResult::TempFileError;
+            }
+            intermediateMerges++;
+            if (level + 1 == levels.size()) {
+                levels.emplace_back();
+            }
+            levels[level + 1].push_back(std::move(merged));
+        }
+
+        if (!headless) {
+            if (runCount == 1) {
+                minValue = run.front();
+                valueRange = std::max(1ll, (long long) run.back() - run.front());
+            }
+
+            std::vector<int> slots;
+            for (int slot = viewSlot(runStart); slot < view.size() && slotPosition(slot) < runStart + length; slot++) {
+                view[slot] = viewValue(run[slotPosition(slot) - runStart]);
+                slots.push_back(slot);
+            }
+            if (!slots.empty()) {
+                colorRange(slots.front(), slots.back() + 1,
+                           segmentColors[(runCount - 1) % IM_ARRAYSIZE(segmentColors)]);
+                visualizeBatch(view, delay * 100.f, slots);
+            }
+        }
+
+        runStart += length;
+    }
+    run = std::vector<int>();
+
+    // the smallest runs first, merged until the rest fits into the final pass
+    std::vector<RunFile> runFiles;
+    for (std::vector<RunFile> &level: levels) {
+        std::move(level.begin(), level.end(), std::back_inserter(runFiles));
+    }
+    while (runFiles.size() > maxMergeFanIn) {
+        int groupSize = std::min<int>(maxMergeFanIn, runFiles.size() - maxMergeFanIn + 1);
+        RunFile merged = mergeIntoTempFile(runFiles, 0, groupSize, memoryBytes);
+        if (!merged.file) {
+            return ExternalSortResult::TempFileError;
+        }
+        intermediateMerges++;
+        runFiles.push_back(std::move(merged));
+    }
+
+    sf::Time runTime = clock.restart();
+
+    // final merge
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> output(std::fopen(outputPath.c_str(), "wb"), std::fclose);
+    if (!output) {
+        return ExternalSortResult::FileError;
+    }
+
+    int nextSlot = 0;
+    bool written = mergeRunFiles(runFiles, output.get(), memoryBytes, [&](long long position, int value) {
+        // the merged prefix replaces the runs in the view
+        if (!headless && nextSlot < view.size() && position == slotPosition(nextSlot)) {
+            view[nextSlot] = viewValue(value);
+            colorRange(nextSlot, nextSlot + 1, sf::Color::White);
+            visualize(view, delay, nextSlot);
+            nextSlot++;
+        }
+    });
+    if (!written) {
+        return ExternalSortResult::FileError;
+    }
+
+    sf::Time mergeTime = clock.restart();
+
+    // each phase reads and writes the whole file once, intermediate merges count towards run generation
+    double megabytes = 2.0 * elementCount * sizeof(int) / (1024 * 1024);
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %lld elements in %d runs of up to %zu, %d intermediate merges:"
+                                      " run generation %.3f ms (%.1f MB/s), merge %.3f ms (%.1f MB/s)",
+                  elementCount, runCount, runCapacity, intermediateMerges, runTime.asMicroseconds() / 1000.0,
+                  megabytes / std::max(runTime.asSeconds(), 1e-6f), mergeTime.asMicroseconds() / 1000.0,
+                  megabytes / std::max(mergeTime.asSeconds(), 1e-6f));
+    sortReport.emplace_back(line);
+
+    return ExternalSortResult::Sorted;
+}
+
+// comparison of the generic algorithms that orders element ids through an adversary
+struct AdversaryLess {
+    using Policy = NoInstrumentation;
+
+    AntiQuicksort *adversary;
+
+    // ids are 1 ... n like the array lessThan() sees, the adversary indexes from 0
+    bool operator()(int a, int b) const {
+        return adversary->less(a - 1, b - 1);
+    }
+};
+
+// percentage of the elements swapped by the nearly-sorted distribution, set by --swaps
+float swapPercent = 0.1f;
+
+void fillAscending(std::vector<int> &array) {
+    for (int i = 0; i < array.size(); i++) {
+        array[i] = i + 1;
+    }
+}
+
+// uniform double in [0, 1)
+double randomUnit(Xoshiro256 &generator) {
+    return (generator() >> 11) * 0x1.0p-53;
+}
+
+struct InputDistribution {
+    const char *id; // used to select the distribution in headless mode
+    const char *name;
+    void (*generate)(std::vector<int> &array); // fills the array with values in [1, size], visualizing its swaps
+};
+
+// inputs in the order of the combo box, random is the default
+const InputDistribution inputDistributions[] = {
+        {"random",        "Random",          [](std::vector<int> &array) {
+            fillAscending(array);
+            shuffle(array);
+        }},
+        {"uniform",       "Uniform Values",  [](std::vector<int> &array) {
+            Xoshiro256 streams = randomStream(RandomStream::Values);
+            fillRandom(array.data(), array.size(), 1, array.size(), streams);
+        }},
+        {"sorted",        "Sorted",          [](std::vector<int> &array) {
+            fillAscending(array);
+        }},
+        {"reversed",      "Reversed",        [](std::vector<int> &array) {
+            fillAscending(array);
+            std::reverse(array.begin(), array.end());
+        }},
+        {"nearly-sorted", "Nearly Sorted",   [](std::vector<int> &array) {
+            fillAscending(array);
+            randomSwaps(array, std::max(1, (int) (array.size() * swapPercent / 100)));
+        }},
+        {"few-unique",    "Few Unique",      [](std::vector<int> &array) {
+            for (int i = 0; i < array.size(); i++) {
+                array[i] = i % 16 + 1;
+            }
+            shuffle(array);
+        }},
+        {"organ-pipe",    "Organ Pipe",      [](std::vector<int> &array) {
+            int size = array.size();
+            for (int i = 0; i < size; i++) {
+                array[i] = i < size / 2 ? 2 * i + 1 : 2 * (size - i);
+            }
+        }},
+        {"sawtooth",      "Sawtooth",        [](std::vector<int> &array) {
+            // 8 ascending runs over the whole value range
+            int size = array.size();
+            int runLength = std::max(1, size / 8);
+            for (int i = 0; i < size; i++) {
+                array[i] = (long long) (i % runLength) * size / runLength + 1;
+            }
+        }},
+        {"zipf",          "Zipf",            [](std::vector<int> &array) {
+            // value k with probability about 1 / k, by inverting the continuous density 1 / x on [1, size + 1)
+            Xoshiro256 generator = randomStream(RandomStream::Values);
+            double logRange = std::log(array.size() + 1.0);
+            for (int &element: array) {
+                element = std::clamp((int) std::exp(randomUnit(generator) * logRange), 1, (int) array.size());
+            }
+        }},
+        {"gaussian",      "Gaussian",        [](std::vector<int> &array) {
+            // Box-Muller, mean size / 2 and standard deviation size / 8
+            Xoshiro256 generator = randomStream(RandomStream::Values);
+            double size = array.size();
+            for (int &element: array) {
+                double radius = std::sqrt(-2 * std::log(1 - randomUnit(generator)));
+                double normal = radius * std::cos(2 * std::numbers::pi * randomUnit(generator));
+                element = std::clamp((int) std::lround(size / 2 + normal * size / 8), 1, (int) array.size());
+            }
+        }},
+        {"all-equal",     "All Equal",       [](std::vector<int> &array) {
+            std::fill(array.begin(), array.end(), array.size() / 2 + 1);
+        }},
+        {"killer",        "Quicksort Killer", [](std::vector<int> &array) {
+            // the input the adversary builds against Quick Sort
+            std::vector<int> ids(array.size());
+            fillAscending(ids);
+            AntiQuicksort adversary(array.size());
+            quickSort(ids, sf::Time::Zero, AdversaryLess{&adversary});
+            adversary.freezeAll();
+            for (int i = 0; i < array.size(); i++) {
+                array[i] = adversary.values[i] + 1;
+            }
+        }},
+};
+
+const int inputDistributionCount = IM_ARRAYSIZE(inputDistributions);
+
+const InputDistribution *findDistribution(const char *id) {
+
+    for (const InputDistribution &distribution: inputDistributions) {
+        if (std::strcmp(distribution.id, id) == 0) {
+            return &distribution;
+        }
+    }
+
+    return nullptr;
+}
+
+struct SortAlgorithm {
+    const char *id; // used to select the algorithm in headless mode
+    const char *name;
+    void (*sort)(std::vector<int> &array);
+};
+
+// algorithms in the order of the combo box, each sorted with its default delay
+const SortAlgorithm sortAlgorithms[] = {
+        {"bubble",     "Bubble Sort",       [](std::vector<int> &array) { bubbleSort(array); }},
+        {"insertion",  "Insertion Sort",    [](std::vector<int> &array) { insertionSort(array); }},
+        {"binary",     "Binary Insertion Sort", [](std::vector<int> &array) { binaryInsertionSort(array); }},
+        {"fordjohnson", "Merge Insertion Sort", [](std::vector<int> &array) { mergeInsertionSort(array); }},
+        {"selection",  "Selection Sort",    [](std::vector<int> &array) { selectionSort(array); }},
+        {"cycle",      "Cycle Sort",        [](std::vector<int> &array) { cycleSort(array); }},
+        {"heap",       "Heap Sort",         [](std::vector<int> &array) { heapSort(array); }},
+        {"heap4",      "4-ary Heap Sort",   [](std::vector<int> &array) { quaternaryHeapSort(array); }},
+        {"merge",      "Merge Sort",        [](std::vector<int> &array) { mergeSort(array); }},
+        {"cache-merge", "Cache-Blocked Merge Sort", [](std::vector<int> &array) { cacheMergeSort(array); }},
+        {"tim",        "Tim Sort",          [](std::vector<int> &array) { timSort(array); }},
+        {"block",      "Block Merge Sort",  [](std::vector<int> &array) { blockMergeSort(array); }},
+        {"sample",     "Sample Sort",       [](std::vector<int> &array) { sampleSort(array); }},
+        {"bitonic",    "Bitonic Sort",      [](std::vector<int> &array) { bitonicSort(array); }},
+        {"oddeven-merge", "Odd-Even Merge Sort", [](std::vector<int> &array) { oddEvenMergeSort(array); }},
+        {"oddeven",    "Odd-Even Transposition Sort",
+                [](std::vector<int> &array) { oddEvenTranspositionSort(array); }},
+        {"quick",      "Quick Sort",        [](std::vector<int> &array) { quickSort(array); }},
+        {"vquick",     "Vector Quick Sort", [](std::vector<int> &array) { vectorQuickSort(array); }},
+        {"shell",      "Shell Sort (Ciura)", [](std::vector<int> &array) { shellSort(array, GapSequence::Ciura); }},
+        {"shell-tokuda", "Shell Sort (Tokuda)", [](std::vector<int> &array) { shellSort(array, GapSequence::Tokuda); }},
+        {"shell-sedgewick", "Shell Sort (Sedgewick)",
+                [](std::vector<int> &array) { shellSort(array, GapSequence::Sedgewick); }},
+        {"shell-knuth", "Shell Sort (Knuth)", [](std::vector<int> &array) { shellSort(array, GapSequence::Knuth); }},
+        {"shell-shell", "Shell Sort (Shell)", [](std::vector<int> &array) { shellSort(array, GapSequence::Shell); }},
+        {"counting",   "Counting Sort",     [](std::vector<int> &array) { countingSort(array); }},
+        {"pigeonhole", "Pigeonhole Sort",   [](std::vector<int> &array) { pigeonholeSort(array); }},
+        {"radix",      "Radix Sort",        [](std::vector<int> &array) { radixSort(array); }},
+};
+
+// library sorts to compare against in headless mode, not offered in the visualizer
+const SortAlgorithm baselineAlgorithms[] = {
+        {"std",        "std::sort",         [](std::vector<int> &array) {
+            std::sort(array.begin(), array.end(), [](int a, int b) { return lessThan(a, b); });
+        }},
+        {"stable",     "std::stable_sort",  [](std::vector<int> &array) {
+            std::stable_sort(array.begin(), array.end(), [](int a, int b) { return lessThan(a, b); });
+        }},
+        {"ranges",     "std::ranges::sort", [](std::vector<int> &array) {
+            std::ranges::sort(array, [](int a, int b) { return lessThan(a, b); });
+        }},
+};
+
+const int sortAlgorithmCount = IM_ARRAYSIZE(sortAlgorithms);
+
+const SortAlgorithm *findAlgorithm(const char *id) {
+
+    for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+        if (std::strcmp(sortAlgorithm.id, id) == 0) {
+            return &sortAlgorithm;
+        }
+    }
+
+    for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+        if (std::strcmp(sortAlgorithm.id, id) == 0) {
+            return &sortAlgorithm;
+        }
+    }
+
+    return nullptr;
+}
+
+// element with satellite data for --type record: sorted by key, the payload is moved along
+struct Record {
+    std::uint64_t key;
+    std::uint64_t payload[7];
+};
+
+// how the typed headless runs order an element type: records by their key, everything else by value
+template<typename T>
+struct ElementOrder {
+    static std::identity projection() { return {}; }
+};
+
+template<>
+struct ElementOrder<Record> {
+    static auto projection() { return &Record::key; }
+};
+
+// an algorithm of the generic layer instantiated for elements of type T, selected by the same ids as sortAlgorithms
+template<typename T>
+struct TypedSortAlgorithm {
+    const char *id;
+    const char *name;
+    void (*sort)(std::vector<T> &array);
+};
+
+// The algorithms that are templated on the element type, with the radix variant that fits the key type. Every entry
+// is compiled for the comparison of T and the instrumentation policy, so NoInstrumentation runs at native speed.
+template<typename T, typename Instrumentation>
+std::vector<TypedSortAlgorithm<T>> typedSortAlgorithms() {
+
+    using Order = ElementOrder<T>;
+    using Less = KeyLess<decltype(Order::projection()), std::ranges::less, Instrumentation>;
+
+    std::vector<TypedSortAlgorithm<T>> algorithms = {
+            {"bubble",    "Bubble Sort",           [](std::vector<T> &array) {
+                bubbleSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"insertion", "Insertion Sort",        [](std::vector<T> &array) {
+                insertionSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"binary",    "Binary Insertion Sort", [](std::vector<T> &array) {
+                binaryInsertionSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"selection", "Selection Sort",        [](std::vector<T> &array) {
+                selectionSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"heap",      "Heap Sort",             [](std::vector<T> &array) {
+                heapSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"heap4",     "4-ary Heap Sort",       [](std::vector<T> &array) {
+                quaternaryHeapSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"merge",     "Merge Sort",            [](std::vector<T> &array) {
+                mergeSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"quick",     "Quick Sort",            [](std::vector<T> &array) {
+                quickSort(array, sf::Time::Zero, Less{Order::projection()});
+            }},
+            {"shell",     "Shell Sort (Ciura)",    [](std::vector<T> &array) {
+                shellSort(array, GapSequence::Ciura, sf::Time::Zero, Less{Order::projection()});
+            }},
+    };
+
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        algorithms.push_back({"radix", "MSD Radix Sort", [](std::vector<T> &array) {
+            stringRadixSort(array, Less{Order::projection()});
+        }});
+    } else {
+        algorithms.push_back({"radix", "LSD Radix Sort (bytes)", [](std::vector<T> &array) {
+            byteRadixSort(array, Less{Order::projection()});
+        }});
+    }
+
+    algorithms.push_back({"std", "std::sort", [](std::vector<T> &array) {
+        std::sort(array.begin(), array.end(), Less{Order::projection()});
+    }});
+    algorithms.push_back({"stable", "std::stable_sort", [](std::vector<T> &array) {
+        std::stable_sort(array.begin(), array.end(), Less{Order::projection()});
+    }});
+    algorithms.push_back({"ranges", "std::ranges::sort", [](std::vector<T> &array) {
+        std::ranges::sort(array, Less{Order::projection()});
+    }});
+
+    return algorithms;
+}
+
+void printHeadlessUsage() {
+    std::printf("usage: sortingvisualizer --headless [--size <n>] [--distribution <id>] [--swaps <percent>]"
+                " [--seed <n>] [--threads <n>]\n"
+                "           [--type int|uint64|float|double|string|record] [--instrumentation count|none]\n"
+                "           [--compare-work <n>] [--read-cost <x>] [--write-cost <x>] [--compare-cost <x>]\n"
+                "           [--merge-benchmark] [--adversary] [--algorithm <id>]...\n");
+    std::printf("       sortingvisualizer --headless --external <file> [--output <file>] [--memory <MiB>]\n");
+    std::printf("       sortingvisualizer --headless --load <file> [--format u32|u64|f32|csv] [--column <n>]"
+                " [--save <file>]\n"
+                "           [--instrumentation count|none] [--algorithm <id>]...\n");
+    std::printf("       sortingvisualizer --headless --benchmark [--sizes <n,n,...>] [--max-size <n>] [--warmup <n>]"
+                " [--repetitions <n>]\n"
+                "           [--time-limit <seconds>] [--pin <core>] [--json <file>] [--csv <file>]"
+                " [--distribution <id>]... [--type <type>]...\n"
+                "           [--instrumentation count|none] [--seed <n>] [--threads <n>] [--algorithm <id>]...\n");
+    std::printf("       sortingvisualizer --headless --compare <baseline.json> <candidate.json> [--threshold <percent>]"
+                " [--confidence <percent>] [--seed <n>]\n");
+    std::printf("       sortingvisualizer --headless --generate <file> [--size <n>]\n");
+    std::printf("algorithms:");
+    for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+        std::printf(" %s", sortAlgorithm.id);
+    }
+    for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+        std::printf(" %s", sortAlgorithm.id);
+    }
+    std::printf("\ndistributions:");
+    for (const InputDistribution &inputDistribution: inputDistributions) {
+        std::printf(" %s", inputDistribution.id);
+    }
+    std::printf("\n");
+}
+
+// merges k presorted runs of the input in one loser tree pass and with repeated pairwise passes, k = 2 ... 1024
+void runMergeBenchmark(const std::vector<int> &input) {
+
+    int size = input.size();
+
+    std::printf("%6s %16s %12s %16s %12s\n", "runs", "k-way compares", "time (ms)", "2-way compares", "time (ms)");
+
+    for (int k = 2; k <= 1024 && k <= size; k *= 2) {
+
+        int runSize = (size + k - 1) / k;
+        std::vector<int> runs = input;
+        std::vector<int> runBegin;
+        std::vector<int> runEnd;
+        for (int begin = 0; begin < size; begin += runSize) {
+            int end = std::min(begin + runSize, size);
+            std::sort(runs.begin() + begin, runs.begin() + end);
+            runBegin.push_back(begin);
+            runEnd.push_back(end);
+        }
+
+        std::vector<int> merged(size);
+        comparisonCount = 0;
+        sf::Clock clock;
+        multiwayMerge(runs, merged, runBegin, runEnd, sf::Time::Zero);
+        sf::Time multiwayTime = clock.getElapsedTime();
+        unsigned long long multiwayComparisons = comparisonCount;
+
+        std::vector<int> temp(size);
+        comparisonCount = 0;
+        clock.restart();
+        mergePasses(runs, temp, 0, size, runSize, sf::Time::Zero);
+        sf::Time pairwiseTime = clock.getElapsedTime();
+
+        std::printf("%6d %16llu %12.3f %16llu %12.3f%s\n", (int) runBegin.size(), multiwayComparisons,
+                    multiwayTime.asMicroseconds() / 1000.0, comparisonCount, pairwiseTime.asMicroseconds() / 1000.0,
+                    std::is_sorted(merged.begin(), merged.end()) && merged == runs ? "" : "  NOT SORTED");
+    }
+}
+
+// writes size random ints in [1, 2^30) as a binary input file for --external
+bool generateFile(const std::string &path, long long size) {
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path.c_str(), "wb"), std::fclose);
+    if (!file) {
+        return false;
+    }
+
+    Xoshiro256 streams = randomStream(RandomStream::Values);
+
+    std::vector<int> block(1 << 24);
+    for (long long written = 0; written < size; written += block.size()) {
+        block.resize(std::min((long long) block.size(), size - written));
+        fillRandom(block.data(), block.size(), 1, (1 << 30) - 1, streams);
+        if (std::fwrite(block.data(), sizeof(int), block.size(), file.get()) != block.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// whether a binary file of ints is sorted, read in blocks
+bool fileIsSorted(const std::string &path) {
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path.c_str(), "rb"), std::fclose);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<int> block(1 << 20);
+    int previous = std::numeric_limits<int>::min();
+    while (size_t length = std::fread(block.data(), sizeof(int), block.size(), file.get())) {
+        if (block[0] < previous || !std::is_sorted(block.begin(), block.begin() + length)) {
+            return false;
+        }
+        previous = block[length - 1];
+    }
+
+    return true;
+}
+
+// Read-only view of a whole file: mapped and prefaulted where mmap is available, read into memory elsewhere
+struct MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+    bool valid = false;
+
+#ifdef MMAP_FILES
+    explicit MappedFile(const std::string &path) {
+
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return;
+        }
+
+        struct stat status{};
+        if (fstat(descriptor, &status) == 0) {
+            size = status.st_size;
+            valid = size == 0;
+
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE;
+#endif
+            void *mapping = size == 0 ? MAP_FAILED : mmap(nullptr, size, PROT_READ, flags, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, size, MADV_SEQUENTIAL);
+                data = (const char *) mapping;
+                valid = true;
+            }
+        }
+
+        close(descriptor);
+    }
+
+    ~MappedFile() {
+        if (data != nullptr) {
+            munmap((void *) data, size);
+        }
+    }
+#else
+    std::vector<char> buffer;
+
+    explicit MappedFile(const std::string &path) {
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return;
+        }
+
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+        valid = true;
+    }
+#endif
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+};
+
+// loads a raw little-endian array of T, fails if the file is not a whole number of elements or too large to index
+template<typename T>
+bool loadBinary(const std::string &path, std::vector<T> &array) {
+
+    MappedFile file(path);
+    if (!file.valid || file.size % sizeof(T) != 0 || file.size / sizeof(T) > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    array.resize(file.size / sizeof(T));
+    if (!array.empty()) {
+        std::memcpy(array.data(), file.data, file.size);
+    }
+
+    if constexpr (std::endian::native == std::endian::big) {
+        using Bits = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        for (T &element: array) {
+            element = std::bit_cast<T>(std::byteswap(std::bit_cast<Bits>(element)));
+        }
+    }
+
+    return true;
+}
+
+// Parses field column (0-based, comma separated) of every line of a CSV file as a double. The file is split into
+// chunks at line breaks that are parsed on the worker threads with std::from_chars. Lines whose field is not a number,
+// like a header, are counted in skipped. Quoted fields are not supported.
+bool loadCsvColumn(const std::string &path, int column, std::vector<double> &values, long long &skipped) {
+
+    MappedFile file(path);
+    if (!file.valid) {
+        return false;
+    }
+
+    const char *begin = file.data;
+    const char *end = file.data + file.size;
+
+    int chunkCount = std::max(1, (int) std::min<size_t>(threadCount * 4, file.size / (1 << 16)));
+    std::vector<const char *> bounds(chunkCount + 1, end);
+    bounds[0] = begin;
+    for (int chunk = 1; chunk < chunkCount; chunk++) {
+        const char *bound = std::max(bounds[chunk - 1], begin + file.size * chunk / chunkCount);
+        const char *lineBreak = std::find(bound, end, '\n');
+        bounds[chunk] = lineBreak == end ? end : lineBreak + 1;
+    }
+
+    std::vector<std::vector<double>> chunkValues(chunkCount);
+    std::vector<long long> chunkSkipped(chunkCount);
+
+    parallelFor(chunkCount, [&](int chunk) {
+        const char *line = bounds[chunk];
+        while (line < bounds[chunk + 1]) {
+            const char *lineEnd = std::find(line, bounds[chunk + 1], '\n');
+
+            const char *field = line;
+            for (int i = 0; i < column && field < lineEnd; i++) {
+                field = std::find(field, lineEnd, ',');
+                field += field < lineEnd;
+            }
+            const char *fieldEnd = std::find(field, lineEnd, ',');
+            while (field < fieldEnd && *field == ' ') {
+                field++;
+            }
+            while (fieldEnd > field && (fieldEnd[-1] == ' ' || fieldEnd[-1] == '\r')) {
+                fieldEnd--;
+            }
+
+            double value;
+            auto [parsed, error] = std::from_chars(field, fieldEnd, value);
+            bool blank = lineEnd == line || (lineEnd - line == 1 && *line == '\r');
+            if (error == std::errc() && parsed == fieldEnd && field < fieldEnd) {
+                chunkValues[chunk].push_back(value);
+            } else if (!blank) {
+                chunkSkipped[chunk]++;
+            }
+
+            line = lineEnd + 1;
+        }
+    });
+
+    size_t total = 0;
+    for (const std::vector<double> &chunk: chunkValues) {
+        total += chunk.size();
+    }
+    if (total > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    values.clear();
+    values.reserve(total);
+    skipped = 0;
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        values.insert(values.end(), chunkValues[chunk].begin(), chunkValues[chunk].end());
+        skipped += chunkSkipped[chunk];
+    }
+
+    return true;
+}
+
+// writes the array as raw binary through a shared mapping of the output file, with plain writes where mmap is missing
+template<typename T>
+bool saveBinary(const std::string &path, const std::vector<T> &array) {
+
+    size_t bytes = array.size() * sizeof(T);
+
+#ifdef MMAP_FILES
+    int descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    bool written = bytes == 0;
+    if (bytes > 0 && ftruncate(descriptor, bytes) == 0) {
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (mapping != MAP_FAILED) {
+            std::memcpy(mapping, array.data(), bytes);
+            written = munmap(mapping, bytes) == 0;
+        }
+    }
+
+    return close(descriptor) == 0 && written;
+#else
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(std::fopen(path.c_str(), "wb"), std::fclose);
+    return file && std::fwrite(array.data(), 1, bytes, file.get()) == bytes;
+#endif
+}
+
+// up to count evenly spaced elements of a loaded dataset as the level of detail the visualizer can draw
+template<typename T>
+std::vector<double> strideSample(const std::vector<T> &array, int count) {
+
+    std::vector<double> sample;
+    int size = std::min<long long>(count, array.size());
+    for (int i = 0; i < size; i++) {
+        sample.push_back((double) array[(long long) i * array.size() / size]);
+    }
+
+    return sample;
+}
+
+// ranks 1 ... k of the values in their order, equal values share a rank, so any dataset draws as positive bars
+std::vector<int> valueRanks(const std::vector<double> &values) {
+
+    std::vector<int> order(values.size());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return values[a] < values[b]; });
+
+    std::vector<int> ranks(values.size());
+    int rank = 0;
+    for (int i = 0; i < order.size(); i++) {
+        if (i == 0 || values[order[i - 1]] < values[order[i]]) {
+            rank++;
+        }
+        ranks[order[i]] = rank;
+    }
+
+    return ranks;
+}
+
+// Loads a dataset for the visualizer and keeps count evenly spaced elements of it, elementCount is the size of the
+// whole dataset. Returns false if the file cannot be loaded in the format.
+bool loadDatasetSample(const std::string &path, const std::string &format, int column, int count,
+                       std::vector<double> &sample, long long &elementCount) {
+
+    bool loaded = false;
+    if (format == "u32") {
+        std::vector<std::uint32_t> data;
+        loaded = loadBinary(path, data);
+        elementCount = data.size();
+        sample = strideSample(data, count);
+    } else if (format == "u64") {
+        std::vector<std::uint64_t> data;
+        loaded = loadBinary(path, data);
+        elementCount = data.size();
+        sample = strideSample(data, count);
+    } else if (format == "f32") {
+        std::vector<float> data;
+        loaded = loadBinary(path, data);
+        elementCount = data.size();
+        sample = strideSample(data, count);
+    } else {
+        std::vector<double> data;
+        long long skipped;
+        loaded = loadCsvColumn(path, column, data, skipped);
+        elementCount = data.size();
+        sample = strideSample(data, count);
+    }
+
+    return loaded;
+}
+
+// one row of the headless table with the operation counts of the last run and the lines it reported
+void printResult(const char *name, int size, sf::Time elapsed, bool sorted) {
+
+    std::printf("%-28s %12d %16llu %16llu %16.0f %12.3f%s\n", name, size, comparisonCount, writeCount, modeledCost(),
+                elapsed.asMicroseconds() / 1000.0, sorted ? "" : "  NOT SORTED");
+
+    for (const std::string &line: sortReport) {
+        std::printf("%s\n", line.c_str());
+    }
+}
+
+// Sorts the ids 1 ... n with every selected algorithm (all if none) against the antiqsort adversary, so the comparison
+// count is the most it could force, and replays the input it built. Sorts that order without lessThan() do not see
+// the adversary. Runs on one thread because the adversary is shared state.
+void runAdversary(int size, std::vector<const SortAlgorithm *> selected) {
+
+    if (selected.empty()) {
+        for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+            selected.push_back(&sortAlgorithm);
+        }
+        for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+            selected.push_back(&sortAlgorithm);
+        }
+    }
+    threadCount = 1;
+
+    std::printf("antiqsort adversary, n log2 n = %.0f\n", size * std::log2(size));
+    std::printf("%-28s %12s %16s %16s %16s %12s\n", "algorithm", "size", "comparisons", "writes", "modeled cost",
+                "time (ms)");
+
+    for (const SortAlgorithm *sortAlgorithm: selected) {
+
+        std::vector<int> array(size);
+        fillAscending(array);
+        AntiQuicksort adversary(size);
+
+        comparisonCount = 0;
+        writeCount = 0;
+        sortReport.clear();
+
+        activeAdversary = &adversary;
+        sf::Clock clock;
+        sortAlgorithm->sort(array);
+        sf::Time elapsed = clock.getElapsedTime();
+        activeAdversary = nullptr;
+
+        unsigned long long comparisons = comparisonCount;
+        unsigned long long writes = writeCount;
+        std::vector<std::string> report = std::move(sortReport);
+        int gasCount = std::ranges::count(adversary.values, adversary.gas);
+        bool seen = adversary.solidCount > 0;
+
+        adversary.freezeAll();
+        bool sorted = std::ranges::is_sorted(array, std::ranges::less{}, [&](int id) {
+            return adversary.values[id - 1];
+        });
+
+        // the same sort on the built input, a deterministic sort repeats the adversary's comparison count
+        std::vector<int> input(size);
+        for (int i = 0; i < size; i++) {
+            input[i] = adversary.values[i] + 1;
+        }
+        comparisonCount = 0;
+        sortAlgorithm->sort(input);
+        unsigned long long replayComparisons = comparisonCount;
+
+        char line[256];
+        if (!seen) {
+            std::snprintf(line, sizeof(line), "  no comparisons through lessThan(), the adversary does not apply");
+        } else if (!sorted) {
+            std::snprintf(line, sizeof(line), "  compares partly without lessThan(), the adversary does not apply");
+        } else {
+            std::snprintf(line, sizeof(line), "  %.2f n log2 n comparisons, %d elements left as gas,"
+                                              " %llu comparisons on the built input", comparisons / (size * std::log2(size)),
+                          gasCount, replayComparisons);
+        }
+        report.emplace_back(line);
+
+        comparisonCount = comparisons;
+        writeCount = writes;
+        sortReport = std::move(report);
+
+        // a sort the adversary saw but does not apply to is judged against values it never answered, not broken
+        printResult(sortAlgorithm->name, size, elapsed, sorted || seen);
+    }
+}
+
+// The int input converted to T without changing its order, so every distribution keeps its shape. Strings are
+// 7 base-26 letters of the value followed by up to 3 more letters and point into strings.
+template<typename T>
+std::vector<T> typedInput(const std::vector<int> &input, std::vector<std::string> &strings) {
+
+    int size = input.size();
+    std::vector<T> array(size);
+
+    for (int i = 0; i < size; i++) {
+        if constexpr (std::is_same_v<T, int>) {
+            array[i] = input[i];
+        } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+            array[i] = (std::uint64_t) input[i] << 32 | (std::uint32_t) (i * 2654435761u);
+        } else if constexpr (std::is_same_v<T, float>) {
+            array[i] = (float) (input[i] - size / 2);
+        } else if constexpr (std::is_same_v<T, double>) {
+            array[i] = (input[i] - size / 2) / 7.0;
+        } else if constexpr (std::is_same_v<T, Record>) {
+            array[i] = {(std::uint64_t) input[i], {(std::uint64_t) i}};
+        } else if constexpr (std::is_same_v<T, std::string_view>) {
+            std::string string(7 + i % 4, 'a');
+            for (int digit = 6, value = input[i]; digit >= 0; digit--, value /= 26) {
+                string[digit] = (char) ('a' + value % 26);
+            }
+            strings.push_back(std::move(string));
+        }
+    }
+
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        for (int i = 0; i < size; i++) {
+            array[i] = strings[i];
+        }
+    }
+
+    return array;
+}
+
+// runs the selected algorithms (all of the generic layer if none) on typed, result keeps the last correctly sorted array
+template<typename T, typename Instrumentation>
+void runTypedArray(const std::vector<T> &typed, const std::vector<const SortAlgorithm *> &selected,
+                   std::vector<T> *result = nullptr) {
+
+    std::vector<TypedSortAlgorithm<T>> algorithms = typedSortAlgorithms<T, Instrumentation>();
+
+    std::vector<const TypedSortAlgorithm<T> *> runs;
+    for (const SortAlgorithm *sortAlgorithm: selected) {
+        auto found = std::find_if(algorithms.begin(), algorithms.end(), [&](const TypedSortAlgorithm<T> &algorithm) {
+            return std::strcmp(algorithm.id, sortAlgorithm->id) == 0;
+        });
+        if (found == algorithms.end()) {
+            std::printf("%-28s not available for this element type and instrumentation\n", sortAlgorithm->name);
+        } else {
+            runs.push_back(&*found);
+        }
+    }
+    if (selected.empty()) {
+        for (const TypedSortAlgorithm<T> &algorithm: algorithms) {
+            runs.push_back(&algorithm);
+        }
+    }
+
+    for (const TypedSortAlgorithm<T> *algorithm: runs) {
+
+        std::vector<T> array = typed;
+
+        comparisonCount = 0;
+        writeCount = 0;
+        sortReport.clear();
+
+        sf::Clock clock;
+        algorithm->sort(array);
+        sf::Time elapsed = clock.getElapsedTime();
+
+        bool sorted = std::ranges::is_sorted(array, std::ranges::less{}, ElementOrder<T>::projection());
+        printResult(algorithm->name, array.size(), elapsed, sorted);
+
+        if (sorted && result != nullptr) {
+            *result = std::move(array);
+        }
+    }
+}
+
+// runTypedArray() on the input converted to T
+template<typename T, typename Instrumentation>
+void runTyped(const std::vector<int> &input, const std::vector<const SortAlgorithm *> &selected) {
+
+    std::vector<std::string> strings;
+    strings.reserve(input.size());
+    runTypedArray<T, Instrumentation>(typedInput<T>(input, strings), selected);
+}
+
+// runs the selected algorithms (all if none) on the int input, result keeps the last correctly sorted array
+void runAlgorithms(const std::vector<int> &input, std::vector<const SortAlgorithm *> selected,
+                   std::vector<int> *result = nullptr) {
+
+    if (selected.empty()) {
+        for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+            selected.push_back(&sortAlgorithm);
+        }
+        for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+            selected.push_back(&sortAlgorithm);
+        }
+    }
+
+    for (const SortAlgorithm *sortAlgorithm: selected) {
+
+        std::vector<int> array = input;
+
+        comparisonCount = 0;
+        writeCount = 0;
+        sortReport.clear();
+
+        sf::Clock clock;
+        sortAlgorithm->sort(array);
+        sf::Time elapsed = clock.getElapsedTime();
+
+        bool sorted = std::is_sorted(array.begin(), array.end());
+        printResult(sortAlgorithm->name, input.size(), elapsed, sorted);
+
+        if (sorted && result != nullptr) {
+            *result = std::move(array);
+        }
+    }
+}
+
+// runTyped() for the element type named by --type
+template<typename Instrumentation>
+void runTypedElements(const std::string &elementType, const std::vector<int> &input,
+                      const std::vector<const SortAlgorithm *> &selected) {
+
+    if (elementType == "uint64") {
+        runTyped<std::uint64_t, Instrumentation>(input, selected);
+    } else if (elementType == "float") {
+        runTyped<float, Instrumentation>(input, selected);
+    } else if (elementType == "double") {
+        runTyped<double, Instrumentation>(input, selected);
+    } else if (elementType == "string") {
+        runTyped<std::string_view, Instrumentation>(input, selected);
+    } else if (elementType == "record") {
+        runTyped<Record, Instrumentation>(input, selected);
+    } else {
+        runTyped<int, Instrumentation>(input, selected);
+    }
+}
+
+// writes the sorted dataset for --save, nothing without a path
+template<typename T>
+bool saveResult(const std::string &path, const std::vector<T> &sorted) {
+
+    if (path.empty()) {
+        return true;
+    }
+    if (sorted.empty()) {
+        std::printf("no algorithm sorted the dataset, %s not written\n", path.c_str());
+        return false;
+    }
+    if (!saveBinary(path, sorted)) {
+        std::printf("cannot write %s\n", path.c_str());
+        return false;
+    }
+
+    std::printf("wrote %zu sorted elements to %s\n", sorted.size(), path.c_str());
+    return true;
+}
+
+// Sorts a dataset file, raw u32/u64/f32 or a CSV column read as doubles, with the selected algorithms and writes the
+// last sorted result to savePath in the same element type. u32 elements run through every int algorithm with their
+// sign bit flipped, which keeps their order.
+template<typename Instrumentation>
+int runLoaded(const std::string &path, const std::string &format, int column, const std::string &savePath,
+              const std::vector<const SortAlgorithm *> &selected) {
+
+    auto printLoaded = [&](size_t count, sf::Time elapsed) {
+        double megabytes = count * (format == "u64" || format == "csv" ? 8.0 : 4.0) / (1024 * 1024);
+        std::printf("%s: %zu %s elements loaded in %.3f ms (%.1f MB/s of elements)\n", path.c_str(), count,
+                    format.c_str(), elapsed.asMicroseconds() / 1000.0,
+                    megabytes / std::max(elapsed.asSeconds(), 1e-6f));
+        std::printf("%-28s %12s %16s %16s %16s %12s\n", "algorithm", "size", "comparisons", "writes",
+                    "modeled cost", "time (ms)");
+    };
+
+    sf::Clock clock;
+
+    if (format == "u32") {
+        std::vector<std::uint32_t> data;
+        if (!loadBinary(path, data)) {
+            std::printf("cannot load %s as u32\n", path.c_str());
+            return 1;
+        }
+        printLoaded(data.size(), clock.getElapsedTime());
+
+        std::vector<int> input(data.size());
+        for (int i = 0; i < input.size(); i++) {
+            input[i] = (int) (data[i] ^ 0x80000000u);
+        }
+
+        // by default, leave out the counting sorts when the keys are too sparse for a histogram
+        std::vector<const SortAlgorithm *> algorithms = selected;
+        if (algorithms.empty() && !input.empty()
+            && valueRange(input) > (long long) sparseRangeFactor * input.size()) {
+            for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+                if (std::strcmp(sortAlgorithm.id, "counting") != 0
+                    && std::strcmp(sortAlgorithm.id, "pigeonhole") != 0) {
+                    algorithms.push_back(&sortAlgorithm);
+                }
+            }
+            for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+                algorithms.push_back(&sortAlgorithm);
+            }
+        }
+
+        std::vector<int> sorted;
+        if constexpr (std::is_same_v<Instrumentation, NoInstrumentation>) {
+            runTypedArray<int, Instrumentation>(input, algorithms, &sorted);
+        } else {
+            runAlgorithms(input, algorithms, &sorted);
+        }
+
+        std::vector<std::uint32_t> output(sorted.size());
+        for (int i = 0; i < sorted.size(); i++) {
+            output[i] = (std::uint32_t) sorted[i] ^ 0x80000000u;
+        }
+        return saveResult(savePath, output) ? 0 : 1;
+    } else if (format == "u64" || format == "f32") {
+        auto run = [&]<typename T>(std::vector<T> data) {
+            if (!loadBinary(path, data)) {
+                std::printf("cannot load %s as %s\n", path.c_str(), format.c_str());
+                return 1;
+            }
+            printLoaded(data.size(), clock.getElapsedTime());
+
+            std::vector<T> sorted;
+            runTypedArray<T, Instrumentation>(data, selected, &sorted);
+            return saveResult(savePath, sorted) ? 0 : 1;
+        };
+        return format == "u64" ? run(std::vector<std::uint64_t>()) : run(std::vector<float>());
+    } else {
+        std::vector<double> data;
+        long long skipped = 0;
+        if (!loadCsvColumn(path, column, data, skipped)) {
+            std::printf("cannot load column %d of %s\n", column, path.c_str());
+            return 1;
+        }
+        if (skipped > 0) {
+            std::printf("%lld lines without a number in column %d skipped\n", skipped, column);
+        }
+        printLoaded(data.size(), clock.getElapsedTime());
+
+        std::vector<double> sorted;
+        runTypedArray<double, Instrumentation>(data, selected, &sorted);
+        return saveResult(savePath, sorted) ? 0 : 1;
+    }
+}
+
+// pins the calling thread to one core (Linux only), the workers of parallelFor keep running on every core
+bool pinToCore(int core) {
+#ifdef __linux__
+    if (!pinnedToCore && sched_getaffinity(0, sizeof(unpinnedAffinity), &unpinnedAffinity) != 0) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        return false;
+    }
+    pinnedToCore = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// the matrix of --benchmark: every selected algorithm on every distribution, size and element type
+struct BenchmarkOptions {
+    std::vector<long long> sizes;
+    std::vector<const InputDistribution *> distributions;
+    std::vector<std::string> types;
+    int warmup = 1;
+    int repetitions = 5;
+    double timeLimit = 1.0; // seconds per repetition, larger sizes are skipped once they are predicted to take longer
+};
+
+// the measurement of one algorithm on one input, times in milliseconds per sort
+struct BenchmarkCase {
+    std::string algorithm;
+    std::string name;
+    std::string distribution;
+    std::string type;
+    long long size;
+    std::vector<double> times;
+    unsigned long long comparisons;
+    unsigned long long writes;
+    bool sorted;
+};
+
+double median(std::vector<double> values) {
+
+    if (values.empty()) {
+        return 0;
+    }
+
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    if (values.size() % 2 == 1) {
+        return *middle;
+    }
+    return (*middle + *std::max_element(values.begin(), middle)) / 2;
+}
+
+// median absolute deviation from the median, a spread that ignores a few disturbed repetitions
+double medianAbsoluteDeviation(const std::vector<double> &values) {
+
+    double center = median(values);
+    std::vector<double> deviations;
+    for (double value: values) {
+        deviations.push_back(std::abs(value - center));
+    }
+
+    return median(deviations);
+}
+
+// copies of an input of this size sorted per timed repetition, so small inputs take long enough to time
+int measureBatch(long long size) {
+    return std::max<long long>(1, (1 << 16) / std::max<long long>(1, size));
+}
+
+// Median time of a sort at size, extrapolated from the last two measured sizes: at least linear growth, or the
+// power of n seen between them if steeper. previousSize is 0 while there is only one measurement.
+double predictedMedian(long long size, long long lastSize, double lastMedian, long long previousSize,
+                       double previousMedian) {
+    double exponent = 1;
+    if (previousSize > 0 && previousMedian > 0 && lastMedian > previousMedian) {
+        exponent = std::max(1.0, std::log(lastMedian / previousMedian) / std::log((double) lastSize / previousSize));
+    }
+    return lastMedian * std::pow((double) size / lastSize, exponent);
+}
+
+// Times sort on copies of input: warm-up runs first, then every repetition sorts a batch of copies, so inputs of a
+// few elements still take long enough to time, and records the time per sort. Counts are per sort.
+template<typename T>
+void measureSort(const std::vector<T> &input, void (*sort)(std::vector<T> &array), const BenchmarkOptions &options,
+                 BenchmarkCase &result) {
+
+    int batch = measureBatch(input.size());
+
+    for (int i = 0; i < options.warmup; i++) {
+        std::vector<T> array = input;
+        sort(array);
+    }
+
+    result.sorted = true;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+
+        std::vector<std::vector<T>> arrays(batch, input);
+
+        comparisonCount = 0;
+        writeCount = 0;
+        sortReport.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::vector<T> &array: arrays) {
+            sort(array);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        result.times.push_back(elapsed.count() / batch);
+        result.comparisons = comparisonCount / batch;
+        result.writes = writeCount / batch;
+        result.sorted = result.sorted && std::ranges::is_sorted(arrays[0], std::ranges::less{},
+                                                                ElementOrder<T>::projection());
+    }
+}
+
+// runs the benchmark matrix of one element type and adds a case per measurement
+template<typename T, typename Instrumentation>
+void benchmarkType(const std::string &type, const BenchmarkOptions &options,
+                   const std::vector<const SortAlgorithm *> &selected, std::vector<BenchmarkCase> &cases) {
+
+    // counted int runs cover every algorithm, everything else the generic layer
+    std::vector<TypedSortAlgorithm<T>> algorithms;
+    if constexpr (std::is_same_v<T, int> && !std::is_same_v<Instrumentation, NoInstrumentation>) {
+        for (const SortAlgorithm &sortAlgorithm: sortAlgorithms) {
+            algorithms.push_back({sortAlgorithm.id, sortAlgorithm.name, sortAlgorithm.sort});
+        }
+        for (const SortAlgorithm &sortAlgorithm: baselineAlgorithms) {
+            algorithms.push_back({sortAlgorithm.id, sortAlgorithm.name, sortAlgorithm.sort});
+        }
+    } else {
+        algorithms = typedSortAlgorithms<T, Instrumentation>();
+    }
+
+    if (!selected.empty()) {
+        std::erase_if(algorithms, [&](const TypedSortAlgorithm<T> &algorithm) {
+            return std::ranges::none_of(selected, [&](const SortAlgorithm *sortAlgorithm) {
+                return std::strcmp(sortAlgorithm->id, algorithm.id) == 0;
+            });
+        });
+    }
+
+    for (const InputDistribution *distribution: options.distributions) {
+
+        // medians of the last two measured sizes of every algorithm, to predict the next one
+        std::vector<double> lastMedian(algorithms.size(), 0);
+        std::vector<double> previousMedian(algorithms.size(), 0);
+        std::vector<long long> lastSize(algorithms.size(), 0);
+        std::vector<long long> previousSize(algorithms.size(), 0);
+
+        for (long long size: options.sizes) {
+
+            std::vector<int> base(size);
+            distribution->generate(base);
+            std::vector<std::string> strings;
+            strings.reserve(size);
+            const std::vector<T> input = typedInput<T>(base, strings);
+
+            for (int i = 0; i < algorithms.size(); i++) {
+
+                if (lastSize[i] > 0 && predictedMedian(size, lastSize[i], lastMedian[i], previousSize[i],
+                                                       previousMedian[i]) > options.timeLimit * 1000) {
+                    continue;
+                }
+
+                BenchmarkCase result{algorithms[i].id, algorithms[i].name, distribution->id, type, size};
+                measureSort(input, algorithms[i].sort, options, result);
+                cases.push_back(result);
+
+                previousMedian[i] = lastMedian[i];
+                previousSize[i] = lastSize[i];
+                lastMedian[i] = median(result.times);
+                lastSize[i] = size;
+
+                std::printf("%-28s %-14s %-8s %12lld %12.4f %10.4f %12.4f %16llu %16llu%s\n", result.name.c_str(),
+                            result.distribution.c_str(), result.type.c_str(), size, lastMedian[i],
+                            medianAbsoluteDeviation(result.times),
+                            *std::min_element(result.times.begin(), result.times.end()), result.comparisons,
+                            result.writes, result.sorted ? "" : "  NOT SORTED");
+                std::fflush(stdout);
+            }
+        }
+    }
+}
+
+template<typename Instrumentation>
+void benchmarkTypes(const BenchmarkOptions &options, const std::vector<const SortAlgorithm *> &selected,
+                    std::vector<BenchmarkCase> &cases) {
+
+    for (const std::string &type: options.types) {
+        if (type == "uint64") {
+            benchmarkType<std::uint64_t, Instrumentation>(type, options, selected, cases);
+        } else if (type == "float") {
+            benchmarkType<float, Instrumentation>(type, options, selected, cases);
+        } else if (type == "double") {
+            benchmarkType<double, Instrumentation>(type, options, selected, cases);
+        } else if (type == "string") {
+            benchmarkType<std::string_view, Instrumentation>(type, options, selected, cases);
+        } else if (type == "record") {
+            benchmarkType<Record, Instrumentation>(type, options, selected, cases);
+        } else {
+            benchmarkType<int, Instrumentation>(type, options, selected, cases);
+        }
+    }
+}
+
+// One case per line so the file stays diffable and easy to read back with --compare. Times are milliseconds per sort.
+bool writeBenchmarkJson(const std::string &path, const std::vector<BenchmarkCase> &cases,
+                        const BenchmarkOptions &options, const std::string &instrumentation, int pinnedCore) {
+
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    file << "{\n  \"seed\": " << randomSeed << ",\n  \"threads\": " << threadCount << ",\n  \"instrumentation\": \""
+         << instrumentation << "\",\n  \"warmup\": " << options.warmup << ",\n  \"repetitions\": "
+         << options.repetitions << ",\n  \"pinned_core\": " << pinnedCore << ",\n  \"cases\": [\n";
+
+    char number[32];
+    for (int i = 0; i < cases.size(); i++) {
+        const BenchmarkCase &result = cases[i];
+        file << "    {\"algorithm\": \"" << result.algorithm << "\", \"name\": \"" << result.name
+             << "\", \"distribution\": \"" << result.distribution << "\", \"type\": \"" << result.type
+             << "\", \"size\": " << result.size;
+        std::snprintf(number, sizeof(number), "%.6f", median(result.times));
+        file << ", \"median_ms\": " << number;
+        std::snprintf(number, sizeof(number), "%.6f", medianAbsoluteDeviation(result.times));
+        file << ", \"mad_ms\": " << number << ", \"comparisons\": " << result.comparisons << ", \"writes\": "
+             << result.writes << ", \"sorted\": " << (result.sorted ? "true" : "false") << ", \"times_ms\": [";
+        for (int j = 0; j < result.times.size(); j++) {
+            std::snprintf(number, sizeof(number), "%.6f", result.times[j]);
+            file << (j == 0 ? "" : ", ") << number;
+        }
+        file << "]}" << (i + 1 < cases.size() ? "," : "") << "\n";
+    }
+
+    file << "  ]\n}\n";
+    return (bool) file;
+}
+
+bool writeBenchmarkCsv(const std::string &path, const std::vector<BenchmarkCase> &cases) {
+
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    file << "algorithm,distribution,type,size,median_ms,mad_ms,min_ms,comparisons,writes,sorted\n";
+    char line[256];
+    for (const BenchmarkCase &result: cases) {
+        std::snprintf(line, sizeof(line), "%s,%s,%s,%lld,%.6f,%.6f,%.6f,%llu,%llu,%d\n", result.algorithm.c_str(),
+                      result.distribution.c_str(), result.type.c_str(), result.size, median(result.times),
+                      medianAbsoluteDeviation(result.times), *std::min_element(result.times.begin(), result.times.end()),
+                      result.comparisons, result.writes, result.sorted);
+        file << line;
+    }
+
+    return (bool) file;
+}
+
+// --benchmark: measures the matrix, prints a row per case and writes the requested JSON and CSV files
+int runBenchmark(const BenchmarkOptions &options, const std::vector<const SortAlgorithm *> &selected,
+                 const std::string &instrumentation, int pinnedCore, const std::string &jsonPath,
+                 const std::string &csvPath) {
+
+    if (pinnedCore >= 0 && !pinToCore(pinnedCore)) {
+        std::printf("cannot pin to core %d, running unpinned\n", pinnedCore);
+        pinnedCore = -1;
+    }
+
+    std::printf("benchmark, seed %llu, %d warm-up runs, %d repetitions, %s, %s\n", (unsigned long long) randomSeed,
+                options.warmup, options.repetitions, instrumentation == "none" ? "uninstrumented" : "counted",
+                pinnedCore >= 0 ? ("pinned to core " + std::to_string(pinnedCore)).c_str() : "not pinned");
+    std::printf("%-28s %-14s %-8s %12s %12s %10s %12s %16s %16s\n", "algorithm", "distribution", "type", "size",
+                "median (ms)", "MAD (ms)", "min (ms)", "comparisons", "writes");
+
+    std::vector<BenchmarkCase> cases;
+    if (instrumentation == "none") {
+        benchmarkTypes<NoInstrumentation>(options, selected, cases);
+    } else {
+        benchmarkTypes<Counted>(options, selected, cases);
+    }
+
+    if (!jsonPath.empty() && !writeBenchmarkJson(jsonPath, cases, options, instrumentation, pinnedCore)) {
+        std::printf("cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    if (!csvPath.empty() && !writeBenchmarkCsv(csvPath, cases)) {
+        std::printf("cannot write %s\n", csvPath.c_str());
+        return 1;
+    }
+
+    return std::ranges::all_of(cases, &BenchmarkCase::sorted) ? 0 : 1;
+}
+
+// the value of "key": in one line of a --json file, which writes every case on its own line
+std::string jsonField(const std::string &line, const std::string &key) {
+
+    size_t position = line.find("\"" + key + "\": ");
+    if (position == std::string::npos) {
+        return "";
+    }
+    position += key.size() + 4;
+
+    if (line[position] == '"') {
+        return line.substr(position + 1, line.find('"', position + 1) - position - 1);
+    }
+    if (line[position] == '[') {
+        return line.substr(position + 1, line.find(']', position) - position - 1);
+    }
+    return line.substr(position, line.find_first_of(",}", position) - position);
+}
+
+// reads the cases of a file written by --json, times only
+bool readBenchmarkJson(const std::string &path, std::vector<BenchmarkCase> &cases) {
+
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find("\"algorithm\": ") == std::string::npos) {
+            continue;
+        }
+
+        BenchmarkCase result{jsonField(line, "algorithm"), jsonField(line, "name"), jsonField(line, "distribution"),
+                             jsonField(line, "type"), std::atoll(jsonField(line, "size").c_str())};
+        std::string times = jsonField(line, "times_ms");
+        for (const char *time = times.c_str(); *time != '\0';) {
+            char *end;
+            double value = std::strtod(time, &end);
+            if (end == time) {
+                break;
+            }
+            result.times.push_back(value);
+            time = end + (*end == ',');
+        }
+        result.sorted = jsonField(line, "sorted") == "true";
+
+        if (!result.times.empty()) {
+            cases.push_back(result);
+        }
+    }
+
+    return true;
+}
+
+// Percentile bootstrap of the speedup median(baseline) / median(candidate): both samples are resampled with
+// replacement, the interval holds the middle confidence share of the resampled speedups.
+std::pair<double, double> bootstrapSpeedup(const std::vector<double> &baseline, const std::vector<double> &candidate,
+                                           double confidence, Xoshiro256 &generator) {
+
+    const int resampleCount = 2000;
+
+    std::vector<double> speedups;
+    std::vector<double> baselineSample(baseline.size());
+    std::vector<double> candidateSample(candidate.size());
+    for (int i = 0; i < resampleCount; i++) {
+        for (double &time: baselineSample) {
+            time = baseline[randomBelow(generator, baseline.size())];
+        }
+        for (double &time: candidateSample) {
+            time = candidate[randomBelow(generator, candidate.size())];
+        }
+        speedups.push_back(median(baselineSample) / std::max(median(candidateSample), 1e-12));
+    }
+
+    std::sort(speedups.begin(), speedups.end());
+    int low = (1 - confidence) / 2 * (resampleCount - 1);
+    return {speedups[low], speedups[resampleCount - 1 - low]};
+}
+
+// seed of the bootstrap of --compare unless --seed is given, so identical invocations give identical intervals
+const std::uint64_t defaultComparisonSeed = 1;
+
+// --compare: matches the cases of two --json files and flags a regression where the confidence interval of the
+// speedup lies entirely below 1 - threshold. Exits with 2 on a regression, and when the candidate has no cases or
+// misses one of the baseline, so scripts can gate on it.
+int runComparison(const std::string &baselinePath, const std::string &candidatePath, double threshold,
+                  double confidence, std::uint64_t seed) {
+
+    std::vector<BenchmarkCase> baseline;
+    std::vector<BenchmarkCase> candidate;
+    if (!readBenchmarkJson(baselinePath, baseline)) {
+        std::printf("cannot read %s\n", baselinePath.c_str());
+        return 1;
+    }
+    if (!readBenchmarkJson(candidatePath, candidate)) {
+        std::printf("cannot read %s\n", candidatePath.c_str());
+        return 1;
+    }
+
+    std::printf("%s -> %s, regression below %.1f%% of the baseline speed at %.0f%% confidence\n",
+                baselinePath.c_str(), candidatePath.c_str(), (1 - threshold) * 100, confidence * 100);
+    std::printf("%-12s %-14s %-8s %12s %14s %14s %9s %21s\n", "algorithm", "distribution", "type", "size",
+                "baseline (ms)", "candidate (ms)", "speedup", "interval");
+
+    Xoshiro256 generator(seed);
+    int regressions = 0;
+    int unmatched = 0;
+
+    for (const BenchmarkCase &before: baseline) {
+
+        auto after = std::ranges::find_if(candidate, [&](const BenchmarkCase &result) {
+            return result.algorithm == before.algorithm && result.distribution == before.distribution
+                   && result.type == before.type && result.size == before.size;
+        });
+        if (after == candidate.end()) {
+            unmatched++;
+            continue;
+        }
+
+        double speedup = median(before.times) / std::max(median(after->times), 1e-12);
+        auto [low, high] = bootstrapSpeedup(before.times, after->times, confidence, generator);
+
+        const char *verdict = "";
+        if (!after->sorted) {
+            verdict = "  NOT SORTED";
+            regressions++;
+        } else if (high < 1 - threshold) {
+            verdict = "  REGRESSION";
+            regressions++;
+        } else if (low > 1 + threshold) {
+            verdict = "  faster";
+        }
+
+        std::printf("%-12s %-14s %-8s %12lld %14.4f %14.4f %8.3fx [%8.3fx, %8.3fx]%s\n", before.algorithm.c_str(),
+                    before.distribution.c_str(), before.type.c_str(), before.size, median(before.times),
+                    median(after->times), speedup, low, high, verdict);
+    }
+
+    if (candidate.empty()) {
+        std::printf("%s has no cases\n", candidatePath.c_str());
+    }
+    if (unmatched > 0) {
+        std::printf("%d baseline cases have no match in %s\n", unmatched, candidatePath.c_str());
+    }
+    std::printf("%d regressions\n", regressions);
+
+    return regressions > 0 || unmatched > 0 || candidate.empty() ? 2 : 0;
+}
+
+// sorts the same shuffled array with every selected algorithm and prints operation counts and time
+int runHeadless(int argc, char *argv[]) {
+
+    int arraySize = 10000;
+    const InputDistribution *distribution = &inputDistributions[0];
+    std::vector<const SortAlgorithm *> selected;
+    bool mergeBenchmark = false;
+    bool adversary = false;
+    std::string elementType = "int";
+    std::string instrumentation = "count";
+    std::string externalPath;
+    std::string outputPath;
+    std::string generatePath;
+    long long memoryMiB = 64;
+    bool benchmark = false;
+    BenchmarkOptions benchmarkOptions;
+    long long maxBenchmarkSize = 1 << 20;
+    int pinnedCore = -1;
+    std::string jsonPath;
+    std::string csvPath;
+    std::string baselinePath;
+    std::string candidatePath;
+    bool seedGiven = false;
+    double threshold = 0.05;
+    double confidence = 0.95;
+    std::string loadPath;
+    std::string loadFormat = "u32";
+    int loadColumn = 0;
+    std::string savePath;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            continue;
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            arraySize = std::max(2, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--external") == 0 && i + 1 < argc) {
+            externalPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+            memoryMiB = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            for (const char *size = argv[++i]; *size != '\0'; size += *size == ',') {
+                char *end;
+                benchmarkOptions.sizes.push_back(std::clamp(std::strtoll(size, &end, 10), 1ll,
+                                                            (long long) std::numeric_limits<int>::max()));
+                size = end;
+            }
+        } else if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            maxBenchmarkSize = std::clamp(std::atoll(argv[++i]), 16ll, (long long) std::numeric_limits<int>::max());
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            benchmarkOptions.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            benchmarkOptions.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            benchmarkOptions.timeLimit = std::max(0.0, std::strtod(argv[++i], nullptr));
+        } else if (std::strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            pinnedCore = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            baselinePath = argv[++i];
+            candidatePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::clamp(std::strtod(argv[++i], nullptr) / 100, 0.0, 0.99);
+        } else if (std::strcmp(argv[i], "--confidence") == 0 && i + 1 < argc) {
+            confidence = std::clamp(std::strtod(argv[++i], nullptr) / 100, 0.5, 0.999);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            loadFormat = argv[++i];
+            if (loadFormat != "u32" && loadFormat != "u64" && loadFormat != "f32" && loadFormat != "csv") {
+                printHeadlessUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--column") == 0 && i + 1 < argc) {
+            loadColumn = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generatePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            randomSeed = std::strtoull(argv[++i], nullptr, 10);
+            seedGiven = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            elementType = argv[++i];
+            benchmarkOptions.types.push_back(elementType);
+            if (elementType != "int" && elementType != "uint64" && elementType != "float" && elementType != "double"
+                && elementType != "string" && elementType != "record") {
+                printHeadlessUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--instrumentation") == 0 && i + 1 < argc) {
+            instrumentation = argv[++i];
+            if (instrumentation != "count" && instrumentation != "none") {
+                printHeadlessUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--merge-benchmark") == 0) {
+            mergeBenchmark = true;
+        } else if (std::strcmp(argv[i], "--adversary") == 0) {
+            adversary = true;
+        } else if (std::strcmp(argv[i], "--compare-work") == 0 && i + 1 < argc) {
+            comparisonWork = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--read-cost") == 0 && i + 1 < argc) {
+            readCost = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (std::strcmp(argv[i], "--write-cost") == 0 && i + 1 < argc) {
+            writeCost = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (std::strcmp(argv[i], "--compare-cost") == 0 && i + 1 < argc) {
+            compareCost = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (std::strcmp(argv[i], "--distribution") == 0 && i + 1 < argc) {
+            const char *id = argv[++i];
+            distribution = findDistribution(id);
+            if (distribution == nullptr) {
+                std::printf("unknown distribution: %s\n", id);
+                printHeadlessUsage();
+                return 1;
+            }
+            benchmarkOptions.distributions.push_back(distribution);
+        } else if (std::strcmp(argv[i], "--swaps") == 0 && i + 1 < argc) {
+            swapPercent = std::clamp(std::strtof(argv[++i], nullptr), 0.0f, 100.0f);
+        } else if (std::strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) {
+            const char *id = argv[++i];
+            const SortAlgorithm *found = findAlgorithm(id);
+            if (found == nullptr) {
+                std::printf("unknown algorithm: %s\n", id);
+                printHeadlessUsage();
+                return 1;
+            }
+            selected.push_back(found);
+        } else {
+            printHeadlessUsage();
+            return 1;
+        }
+    }
+
+    if (!generatePath.empty()) {
+        if (!generateFile(generatePath, arraySize)) {
+            std::printf("cannot write %s\n", generatePath.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!externalPath.empty()) {
+        if (outputPath.empty()) {
+            outputPath = externalPath + ".sorted";
+        }
+
+        std::printf("external sort of %s into %s with %lld MiB of memory\n", externalPath.c_str(), outputPath.c_str(),
+                    memoryMiB);
+        ExternalSortResult result = externalSort(externalPath, outputPath, memoryMiB * 1024 * 1024);
+        if (result == ExternalSortResult::FileError) {
+            std::printf("cannot read %s or write %s\n", externalPath.c_str(), outputPath.c_str());
+            return 1;
+        }
+        if (result == ExternalSortResult::TempFileError) {
+            std::printf("cannot create or write a temporary run file\n");
+            return 1;
+        }
+        for (const std::string &line: sortReport) {
+            std::printf("%s\n", line.c_str());
+        }
+        if (!fileIsSorted(outputPath)) {
+            std::printf("NOT SORTED\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!baselinePath.empty()) {
+        return runComparison(baselinePath, candidatePath, threshold, confidence,
+                             seedGiven ? randomSeed : defaultComparisonSeed);
+    }
+
+    if (benchmark) {
+        // sizes 16, 256, 4096, ... up to --max-size unless listed with --sizes
+        if (benchmarkOptions.sizes.empty()) {
+            for (long long size = 16; size < maxBenchmarkSize; size *= 16) {
+                benchmarkOptions.sizes.push_back(size);
+            }
+            benchmarkOptions.sizes.push_back(maxBenchmarkSize);
+        }
+        if (benchmarkOptions.distributions.empty()) {
+            benchmarkOptions.distributions.push_back(&inputDistributions[0]);
+        }
+        if (benchmarkOptions.types.empty()) {
+            benchmarkOptions.types.push_back("int");
+        }
+        return runBenchmark(benchmarkOptions, selected, instrumentation, pinnedCore, jsonPath, csvPath);
+    }
+
+    if (!loadPath.empty()) {
+        if (instrumentation == "none") {
+            return runLoaded<NoInstrumentation>(loadPath, loadFormat, loadColumn, savePath, selected);
+        }
+        return runLoaded<Counted>(loadPath, loadFormat, loadColumn, savePath, selected);
+    }
+
+    if (adversary) {
+        runAdversary(arraySize, selected);
+        return 0;
+    }
+
+    std::vector<int> input(arraySize);
+    distribution->generate(input);
+
+    if (mergeBenchmark) {
+        std::printf("%s input, seed %llu\n", distribution->id, (unsigned long long) randomSeed);
+        runMergeBenchmark(input);
+        return 0;
+    }
+
+    std::printf("%s %s input, seed %llu, cost per read %g, write %g, compare %g, %d work iterations per comparison\n",
+                distribution->id, elementType.c_str(), (unsigned long long) randomSeed, readCost, writeCost,
+                compareCost, comparisonWork);
+    if (instrumentation == "none") {
+        std::printf("uninstrumented generic algorithms, comparisons and writes are not counted\n");
+    }
+    std::printf("%-28s %12s %16s %16s %16s %12s\n", "algorithm", "size", "comparisons", "writes", "modeled cost",
+                "time (ms)");
+
+    if (instrumentation == "none") {
+        runTypedElements<NoInstrumentation>(elementType, input, selected);
+    } else if (elementType != "int") {
+        runTypedElements<Counted>(elementType, input, selected);
+    } else {
+        runAlgorithms(input, selected);
+    }
+
+    return 0;
+}
+
+// fit of one metric of the analysis window against c * model(n)
+struct ComplexityFit {
+    const char *model = nullptr; // nullptr if the metric was zero everywhere
+    double constant = 0;
+    double error = 0; // root mean square of the residuals in natural log
+    double slope = 0; // of the least squares line through the log-log points
+};
+
+// Fits log y = log c + log model(n) for n, n log n and n^2 and keeps the model with the smallest residuals.
+// Sizes where the metric is zero, like the comparisons of a radix sort, are left out.
+ComplexityFit fitComplexity(const std::vector<BenchmarkCase> &points,
+                            const std::function<double(const BenchmarkCase &)> &metric) {
+
+    std::vector<double> logSizes;
+    std::vector<double> logValues;
+    std::vector<long long> sizes;
+    for (const BenchmarkCase &point: points) {
+        if (metric(point) > 0) {
+            logSizes.push_back(std::log((double) point.size));
+            logValues.push_back(std::log(metric(point)));
+            sizes.push_back(point.size);
+        }
+    }
+
+    ComplexityFit best;
+    if (logSizes.size() < 2) {
+        return best;
+    }
+
+    const std::pair<const char *, double (*)(double)> models[] = {
+            {"n",       [](double n) { return n; }},
+            {"n log n", [](double n) { return n * std::log2(n); }},
+            {"n^2",     [](double n) { return n * n; }},
+    };
+
+    int count = logSizes.size();
+    for (auto [name, model]: models) {
+        std::vector<double> residuals;
+        double mean = 0;
+        for (int i = 0; i < count; i++) {
+            residuals.push_back(logValues[i] - std::log(model(sizes[i])));
+            mean += residuals.back() / count;
+        }
+
+        double error = 0;
+        for (double residual: residuals) {
+            error += (residual - mean) * (residual - mean) / count;
+        }
+        error = std::sqrt(error);
+
+        if (best.model == nullptr || error < best.error) {
+            best.model = name;
+            best.constant = std::exp(mean);
+            best.error = error;
+        }
+    }
+
+    double meanSize = std::accumulate(logSizes.begin(), logSizes.end(), 0.0) / count;
+    double meanValue = std::accumulate(logValues.begin(), logValues.end(), 0.0) / count;
+    double covariance = 0;
+    double variance = 0;
+    for (int i = 0; i < count; i++) {
+        covariance += (logSizes[i] - meanSize) * (logValues[i] - meanValue);
+        variance += (logSizes[i] - meanSize) * (logSizes[i] - meanSize);
+    }
+    best.slope = covariance / variance;
+
+    return best;
+}
+
+// value of a fitted model at n
+double fittedValue(const ComplexityFit &fit, double n) {
+    if (std::strcmp(fit.model, "n") == 0) {
+        return fit.constant * n;
+    }
+    if (std::strcmp(fit.model, "n log n") == 0) {
+        return fit.constant * n * std::log2(n);
+    }
+    return fit.constant * n * n;
+}
+
+// Log-log plot of one metric with the draw list of the current window: measured points in white, the fitted model
+// in yellow if there is one. Both axes span the measured range, labelled with their extremes.
+void drawLogLogPlot(const char *label, const std::vector<BenchmarkCase> &points,
+                    const std::function<double(const BenchmarkCase &)> &metric, const ComplexityFit *fit) {
+
+    if (fit != nullptr && fit->model != nullptr) {
+        ImGui::Text("%s: ~ %.3g * %s (log residual %.3f), log-log slope %.2f", label, fit->constant, fit->model,
+                    fit->error, fit->slope);
+    } else {
+        ImGui::Text("%s", label);
+    }
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(200.0f, ImGui::GetContentRegionAvail().x), 120);
+    ImGui::InvisibleButton(label, size);
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(120, 120, 120, 255));
+
+    std::vector<std::pair<double, double>> logPoints;
+    for (const BenchmarkCase &point: points) {
+        if (metric(point) > 0) {
+            logPoints.emplace_back(std::log10((double) point.size), std::log10(metric(point)));
+        }
+    }
+    if (logPoints.size() < 2) {
+        return;
+    }
+
+    auto [minX, maxX] = std::ranges::minmax(logPoints | std::views::keys);
+    auto [minY, maxY] = std::ranges::minmax(logPoints | std::views::values);
+    maxX = std::max(maxX, minX + 1e-9);
+    maxY = std::max(maxY, minY + 1e-9);
+
+    const float margin = 6;
+    auto toScreen = [&](double x, double y) {
+        return ImVec2(origin.x + margin + (x - minX) / (maxX - minX) * (size.x - 2 * margin),
+                      origin.y + size.y - margin - (y - minY) / (maxY - minY) * (size.y - 2 * margin));
+    };
+
+    if (fit != nullptr && fit->model != nullptr) {
+        for (int i = 1; i < logPoints.size(); i++) {
+            double y0 = std::clamp(std::log10(fittedValue(*fit, std::pow(10, logPoints[i - 1].first))), minY, maxY);
+            double y1 = std::clamp(std::log10(fittedValue(*fit, std::pow(10, logPoints[i].first))), minY, maxY);
+            drawList->AddLine(toScreen(logPoints[i - 1].first, y0), toScreen(logPoints[i].first, y1),
+                              IM_COL32(255, 200, 80, 255), 1.5f);
+        }
+    }
+
+    for (int i = 0; i < logPoints.size(); i++) {
+        ImVec2 point = toScreen(logPoints[i].first, logPoints[i].second);
+        if (i > 0) {
+            drawList->AddLine(toScreen(logPoints[i - 1].first, logPoints[i - 1].second), point,
+                              IM_COL32(255, 255, 255, 255));
+        }
+        drawList->AddCircleFilled(point, 2.5f, IM_COL32(255, 255, 255, 255));
+    }
+
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.3g", std::pow(10, maxY));
+    drawList->AddText(ImVec2(origin.x + margin, origin.y + 2), IM_COL32(170, 170, 170, 255), text);
+    std::snprintf(text, sizeof(text), "%.3g", std::pow(10, minY));
+    drawList->AddText(ImVec2(origin.x + margin, origin.y + size.y - 18), IM_COL32(170, 170, 170, 255), text);
+    std::snprintf(text, sizeof(text), "n = %.0f", std::pow(10, maxX));
+    drawList->AddText(ImVec2(origin.x + size.x - ImGui::CalcTextSize(text).x - margin, origin.y + size.y - 18),
+                      IM_COL32(170, 170, 170, 255), text);
+}
+
+// milliseconds the analysis window may spend measuring in one frame
+const double analysisFrameBudget = 200;
+
+// Measures an algorithm on one input distribution at n = 16, 32, 64, ... without visualizing, one size per frame,
+// and plots comparisons, writes, time and time per element against n. Stops at maxSize, or before a size whose
+// measurement is predicted from the last two to take longer than analysisFrameBudget, so the window stays
+// responsive.
+void analysisWindow(int algorithm, int distribution, bool *open) {
+
+    static std::vector<BenchmarkCase> points;
+    static int analyzedAlgorithm = -1;
+    static int analyzedDistribution = -1;
+    static long long nextSize = 0;
+    static int maxSize = 1 << 20;
+
+    ImGui::Begin("Analysis", open);
+
+    ImGui::Text("%s on %s input", sortAlgorithms[algorithm].name, inputDistributions[distribution].name);
+    ImGui::InputInt("Max Size", &maxSize, 1 << 10, 1 << 16);
+    maxSize = std::clamp(maxSize, 16, 1 << 26);
+
+    if (ImGui::Button(nextSize > 0 ? "Stop" : "Run", ImVec2(100, 20))) {
+        if (nextSize > 0) {
+            nextSize = 0;
+        } else {
+            points.clear();
+            analyzedAlgorithm = algorithm;
+            analyzedDistribution = distribution;
+            nextSize = 16;
+        }
+    }
+
+    BenchmarkOptions options;
+    options.repetitions = 3;
+
+    // points of another algorithm or input do not belong in the same fit
+    if (analyzedAlgorithm != algorithm || analyzedDistribution != distribution) {
+        nextSize = 0;
+    }
+
+    if (nextSize > 0 && !points.empty()) {
+        int last = points.size() - 1;
+        double predicted = predictedMedian(nextSize, points[last].size, median(points[last].times),
+                                           last > 0 ? points[last - 1].size : 0,
+                                           last > 0 ? median(points[last - 1].times) : 0);
+        if (predicted * (options.warmup + options.repetitions * measureBatch(nextSize)) > analysisFrameBudget) {
+            nextSize = 0;
+        }
+    }
+
+    if (nextSize > 0) {
+        // measure like the benchmark mode, keeping the counters of the last visualized sort
+        unsigned long long comparisons = comparisonCount;
+        unsigned long long writes = writeCount;
+        headless = true;
+
+        std::vector<int> input(nextSize);
+        inputDistributions[distribution].generate(input);
+        BenchmarkCase point{sortAlgorithms[algorithm].id, sortAlgorithms[algorithm].name,
+                            inputDistributions[distribution].id, "int", nextSize};
+        measureSort(input, sortAlgorithms[algorithm].sort, options, point);
+        points.push_back(point);
+
+        headless = false;
+        comparisonCount = comparisons;
+        writeCount = writes;
+
+        nextSize = nextSize * 2 <= maxSize ? nextSize * 2 : 0;
+    }
+
+    if (!points.empty()) {
+        ImGui::SameLine();
+        ImGui::Text("n = %lld%s", points.back().size, nextSize > 0 ? ", measuring" : "");
+        if (analyzedAlgorithm != algorithm || analyzedDistribution != distribution) {
+            ImGui::Text("showing %s on %s input", sortAlgorithms[analyzedAlgorithm].name,
+                        inputDistributions[analyzedDistribution].name);
+        }
+
+        auto comparisonsOf = [](const BenchmarkCase &point) { return (double) point.comparisons; };
+        auto writesOf = [](const BenchmarkCase &point) { return (double) point.writes; };
+        auto timeOf = [](const BenchmarkCase &point) { return median(point.times); };
+        auto timePerElementOf = [](const BenchmarkCase &point) { return median(point.times) * 1e6 / point.size; };
+
+        ComplexityFit comparisonFit = fitComplexity(points, comparisonsOf);
+        ComplexityFit writeFit = fitComplexity(points, writesOf);
+        ComplexityFit timeFit = fitComplexity(points, timeOf);
+
+        drawLogLogPlot("comparisons", points, comparisonsOf, &comparisonFit);
+        drawLogLogPlot("writes", points, writesOf, &writeFit);
+        drawLogLogPlot("time (ms)", points, timeOf, &timeFit);
+        // steps here at growing n are cache or memory boundaries
+        drawLogLogPlot("time per element (ns)", points, timePerElementOf, nullptr);
+    }
+
+    ImGui::End();
+}
+
+int main(int argc, char *argv[]) {
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            return runHeadless(argc, argv);
+        }
+    }
+
+    const unsigned int screenWidth = sf::VideoMode::getDesktopMode().width;
+    const unsigned int screenHeight = sf::VideoMode::getDesktopMode().height;
+
+    // create window
+    window.create(sf::VideoMode(screenWidth / 2, screenHeight / 2), "sorting");
+
+    // initialize ImGui
+    if (!ImGui::SFML::Init(window))
+        return 1;
+
+    // load sound
+    if (!soundBuffer.loadFromFile("sort.wav"))
+        return 1;
+
+    highlightSoundA.setBuffer(soundBuffer);
+    highlightSoundB.setBuffer(soundBuffer);
+    highlightSoundA.setVolume(10);
+    highlightSoundB.setVolume(10);
+    highlightSoundA.setLoop(true);
+    highlightSoundB.setLoop(true);
+
+    // initialize array
+    int arraySize = 256;
+    int lastArraySize = arraySize;
+
+    std::vector<int> array = std::vector<int>(arraySize);
+    for (int i = 0; i < array.size(); i++) {
+        array[i] = i + 1;
+    }
+
+    // main loop
+    while (window.isOpen()) {
+
+        // limit framerate to 30 to reduce CPU/GPU usage in controls window
+        window.setFramerateLimit(30);
+
+        // handle events
+        sf::Event event{};
+        while (window.pollEvent(event)) {
+            ImGui::SFML::ProcessEvent(event);
+            switch (event.type) {
+                case sf::Event::Closed:
+                    window.close();
+                case sf::Event::Resized:
+                    window.setView(sf::View(sf::FloatRect(0, 0, event.size.width, event.size.height)));
+            }
+        }
+        ImGui::SFML::Update(window, deltaClock.restart());
+
+        // start of controls window
+        ImGui::Begin("Controls", nullptr, ImGuiWindowFlags_NoCollapse);
+
+        // algorithm combo box
+        static int algorithm = 0;
+        ImGui::Combo("Algorithm", &algorithm, [](void *, int index, const char **name) {
+            *name = sortAlgorithms[index].name;
+            return true;
+        }, nullptr, sortAlgorithmCount);
+
+        // input distribution combo box
+        static int distribution = 0;
+        ImGui::Combo("Input", &distribution, [](void *, int index, const char **name) {
+            *name = inputDistributions[index].name;
+            return true;
+        }, nullptr, inputDistributionCount);
+        if (std::strcmp(inputDistributions[distribution].id, "nearly-sorted") == 0) {
+            ImGui::InputFloat("Swaps (%)", &swapPercent, 0.1f, 1.0f);
+            swapPercent = std::clamp(swapPercent, 0.0f, 100.0f);
+        }
+
+        // builds the input during the sort instead, against whatever the algorithm compares
+        static bool adversaryInput = false;
+        ImGui::Checkbox("Antiqsort Adversary", &adversaryInput);
+
+        // array size input
+        ImGui::InputInt("Array Size", &arraySize, 1, 4);
+        arraySize = std::max(2, std::min(arraySize, 1024));
+
+        // resize array if array size changed
+        if (arraySize != lastArraySize) {
+            array = std::vector<int>(arraySize);
+            for (int i = 0; i < array.size(); i++) {
+                array[i] = i + 1;
+            }
+            lastArraySize = arraySize;
+        }
+
+        // operation counts of the last sort
+        ImGui::Text("Comparisons: %llu", comparisonCount);
+        ImGui::Text("Writes: %llu", writeCount);
+        ImGui::Text("Modeled Cost: %.0f", modeledCost());
+
+        // cost model, raise the write cost to see where write-minimizing sorts pay off
+        ImGui::InputFloat("Read Cost", &readCost, 1, 10);
+        ImGui::InputFloat("Write Cost", &writeCost, 1, 10);
+        ImGui::InputFloat("Compare Cost", &compareCost, 1, 10);
+        readCost = std::max(0.0f, readCost);
+        writeCost = std::max(0.0f, writeCost);
+        compareCost = std::max(0.0f, compareCost);
+
+        // real work per comparison, shows where saving comparisons beats saving moves
+        ImGui::InputInt("Comparison Work", &comparisonWork, 100, 1000);
+        comparisonWork = std::max(0, comparisonWork);
+
+        // seed of the shuffle, a new one for every run unless fixed to repeat a run
+        static bool fixedSeed = false;
+        ImGui::InputScalar("Seed", ImGuiDataType_U64, &randomSeed);
+        ImGui::Checkbox("Fixed Seed", &fixedSeed);
+
+        // visualize button
+        bool visualizeArray = ImGui::Button("Visualize", ImVec2(100, 20));
+
+        // scaling of the selected algorithm in its own window
+        static bool showAnalysis = false;
+        ImGui::SameLine();
+        ImGui::Checkbox("Analysis", &showAnalysis);
+        if (visualizeArray && !fixedSeed) {
+            randomSeed = (std::uint64_t) std::random_device()() << 32 | std::random_device()();
+        }
+
+        ImGui::Separator();
+
+        // external sort of a binary file of ints, written next to it with a .sorted suffix
+        static char externalPath[256] = "";
+        static int memoryMiB = 64;
+        static std::string externalStatus;
+        ImGui::InputText("File", externalPath, IM_ARRAYSIZE(externalPath));
+        ImGui::InputInt("Memory (MiB)", &memoryMiB, 1, 16);
+        memoryMiB = std::max(1, memoryMiB);
+        bool sortFile = ImGui::Button("Sort File", ImVec2(100, 20));
+        if (!externalStatus.empty()) {
+            ImGui::SameLine();
+            ImGui::Text("%s", externalStatus.c_str());
+        }
+
+        ImGui::Separator();
+
+        // dataset file as input: up to 1024 evenly spaced elements are kept and drawn by rank
+        static char datasetPath[256] = "";
+        static int datasetFormat = 0;
+        static int datasetColumn = 0;
+        static bool useDataset = false;
+        static std::vector<double> datasetSample;
+        static std::string datasetStatus;
+        const char *datasetFormats[] = {"u32", "u64", "f32", "csv"};
+        ImGui::InputText("Dataset", datasetPath, IM_ARRAYSIZE(datasetPath));
+        ImGui::Combo("Format", &datasetFormat, datasetFormats, IM_ARRAYSIZE(datasetFormats));
+        if (std::strcmp(datasetFormats[datasetFormat], "csv") == 0) {
+            ImGui::InputInt("Column", &datasetColumn);
+            datasetColumn = std::max(0, datasetColumn);
+        }
+        if (ImGui::Button("Load", ImVec2(100, 20))) {
+            long long elementCount = 0;
+            if (loadDatasetSample(datasetPath, datasetFormats[datasetFormat], datasetColumn, 1024, datasetSample,
+                                  elementCount) && !datasetSample.empty()) {
+                datasetStatus = std::to_string(elementCount) + " elements";
+            } else {
+                datasetSample.clear();
+                datasetStatus = "cannot load the file";
+            }
+            useDataset = !datasetSample.empty();
+        }
+        if (!datasetStatus.empty()) {
+            ImGui::SameLine();
+            ImGui::Text("%s", datasetStatus.c_str());
+        }
+        if (!datasetSample.empty()) {
+            ImGui::Checkbox("Use Dataset", &useDataset);
+        }
+
+        if (showAnalysis) {
+            analysisWindow(algorithm, distribution, &showAnalysis);
+        }
+
+        if (visualizeArray) {
+            ImGui::End(); // end controls window early because it is unneeded during visualization
+
+            // finish rendering controls window
+            window.clear();
+            ImGui::SFML::Render(window);
+            window.display();
+
+            // remove framerate limit for sorting as it limits the speed of the sorting (disadvantage of single thread)
+            window.setFramerateLimit(0);
+
+            sleepRatio = arraySize / 1024.0;
+
+            AntiQuicksort adversary(array.size());
+
+            try {
+
+                visualizeWait(array, sf::seconds(1));
+
+                if (adversaryInput) {
+                    fillAscending(array);
+                    activeAdversary = &adversary;
+                } else if (useDataset) {
+                    std::vector<double> values(array.size());
+                    for (int i = 0; i < values.size(); i++) {
+                        values[i] = datasetSample[(long long) i * datasetSample.size() / values.size()];
+                    }
+                    array = valueRanks(values);
+                } else {
+                    inputDistributions[distribution].generate(array);
+                }
+
+                visualizeWait(array, sf::seconds(1));
+
+                comparisonCount = 0;
+                writeCount = 0;
+
+                sortAlgorithms[algorithm].sort(array);
+
+                // replace the ids with the values the adversary gave them
+                if (activeAdversary != nullptr) {
+                    adversary.freezeAll();
+                    activeAdversary = nullptr;
+                    for (int &element: array) {
+                        element = adversary.values[element - 1] + 1;
+                    }
+                }
+
+                visualizeWait(array, sf::seconds(1));
+
+            } catch (std::exception &e) {
+                // do nothing because exception is thrown by stop button
+            }
+
+            if (activeAdversary != nullptr) {
+                activeAdversary = nullptr;
+                fillAscending(array);
+            }
+
+            elementColors.clear();
+            highlightedIndices.clear();
+        } else if (sortFile) {
+            ImGui::End();
+
+            // the file is visualized as a downsampled view with the same controls as the array
+            window.clear();
+            ImGui::SFML::Render(window);
+            window.display();
+            window.setFramerateLimit(0);
+            sleepRatio = 1.0;
+
+            try {
+                comparisonCount = 0;
+                writeCount = 0;
+                sortReport.clear();
+
+                ExternalSortResult result = externalSort(externalPath, std::string(externalPath) + ".sorted",
+                                                         memoryMiB * 1024ll * 1024);
+                externalStatus = result == ExternalSortResult::Sorted ? "sorted"
+                                 : result == ExternalSortResult::FileError ? "cannot read or write the file"
+                                 : "cannot create a temporary run file";
+            } catch (std::exception &e) {
+                externalStatus = "stopped";
+            }
+
+            elementColors.clear();
+            highlightedIndices.clear();
         } else {
             ImGui::End();
         }